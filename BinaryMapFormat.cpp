@@ -0,0 +1,552 @@
+#include "BinaryMapFormat.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Pathfinder {
+
+    namespace {
+
+        // Sections are copied byte for byte, so their element types must have a fixed layout
+        static_assert(std::is_trivially_copyable<Point>::value && sizeof(Point) == 16, "Point layout changed");
+        static_assert(std::is_trivially_copyable<Trapezoid>::value && sizeof(Trapezoid) == 40, "Trapezoid layout changed");
+        static_assert(std::is_trivially_copyable<Teleporter>::value && sizeof(Teleporter) == 20, "Teleporter layout changed");
+        static_assert(std::is_trivially_copyable<PortalConnection>::value && sizeof(PortalConnection) == 12, "PortalConnection layout changed");
+        static_assert(std::is_trivially_copyable<NpcTravel>::value && sizeof(NpcTravel) == 40, "NpcTravel layout changed");
+        static_assert(std::is_trivially_copyable<EnterTravel>::value && sizeof(EnterTravel) == 20, "EnterTravel layout changed");
+        static_assert(std::is_trivially_copyable<BinaryMapHeader>::value, "BinaryMapHeader must be trivially copyable");
+
+        // Travel portal record; its connections are a range of the connection section
+        struct BinaryTravelPortal {
+            Vec2f position;
+            uint32_t first_connection;
+            uint32_t connection_count;
+        };
+
+        const char kMapMagic[4] = { 'G', 'W', 'N', 'M' };
+        const char kPackMagic[4] = { 'G', 'W', 'N', 'P' };
+
+        template <typename T>
+        void AppendArray(std::vector<uint8_t>& out, const T* items, size_t count) {
+            if (count == 0) {
+                return;
+            }
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(items);
+            out.insert(out.end(), bytes, bytes + count * sizeof(T));
+        }
+
+        // Bounds-checked cursor over a baked map
+        class BinaryReader {
+        public:
+            BinaryReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_pos(0) {}
+
+            template <typename T>
+            bool SkipArray(size_t count) {
+                const size_t bytes = count * sizeof(T);
+                if (count > m_size || bytes > m_size - m_pos) {
+                    return false;
+                }
+                m_pos += bytes;
+                return true;
+            }
+
+            template <typename T>
+            bool ReadArray(std::vector<T>& out, size_t count) {
+                const size_t bytes = count * sizeof(T);
+                if (count > m_size || bytes > m_size - m_pos) {
+                    return false;
+                }
+                out.resize(count);
+                if (bytes > 0) {
+                    std::memcpy(out.data(), m_data + m_pos, bytes);
+                }
+                m_pos += bytes;
+                return true;
+            }
+
+        private:
+            const uint8_t* m_data;
+            size_t m_size;
+            size_t m_pos;
+        };
+
+        bool ReadHeader(const uint8_t* data, size_t size, BinaryMapHeader& out_header) {
+            if (!IsBinaryMap(data, size)) {
+                return false;
+            }
+            std::memcpy(&out_header, data, sizeof(out_header));
+            return out_header.version == kBinaryMapVersion;
+        }
+
+        // Portal, NPC and Enter travel sections, which follow the teleporters
+        bool ReadTravelSections(BinaryReader& reader, const BinaryMapHeader& header,
+                                std::vector<BinaryTravelPortal>& out_portals, std::vector<PortalConnection>& out_connections,
+                                MapData& out_map_data) {
+            return reader.ReadArray(out_portals, header.travel_portal_count)
+                && reader.ReadArray(out_connections, header.portal_connection_count)
+                && reader.ReadArray(out_map_data.npc_travels, header.npc_travel_count)
+                && reader.ReadArray(out_map_data.enter_travels, header.enter_travel_count);
+        }
+
+        // Travel cost section, the last one of a map
+        bool ReadTravelCosts(BinaryReader& reader, const BinaryMapHeader& header, MapData& out_map_data) {
+            TravelCostTable& travel_costs = out_map_data.travel_costs;
+            travel_costs.Clear();
+            return reader.ReadArray(travel_costs.arrivals, header.travel_arrival_count)
+                && reader.ReadArray(travel_costs.costs, header.travel_cost_count);
+        }
+
+        // Rebuilds the travel portals from their records once every travel section is read,
+        // then checks that the travel costs have one column per transition
+        bool FinishTravelData(const std::vector<BinaryTravelPortal>& portals, const std::vector<PortalConnection>& connections,
+                              MapData& out_map_data) {
+            out_map_data.travel_portals.clear();
+            out_map_data.travel_portals.reserve(portals.size());
+            for (const auto& portal : portals) {
+                if (portal.first_connection > connections.size() ||
+                    portal.connection_count > connections.size() - portal.first_connection) {
+                    return false;
+                }
+
+                TravelPortal tp(portal.position.x, portal.position.y);
+                tp.connections.assign(connections.begin() + portal.first_connection,
+                                      connections.begin() + portal.first_connection + portal.connection_count);
+                out_map_data.travel_portals.push_back(std::move(tp));
+            }
+
+            const TravelCostTable& travel_costs = out_map_data.travel_costs;
+            return travel_costs.costs.size() == travel_costs.arrivals.size() * out_map_data.GetTransitions().size();
+        }
+
+    } // namespace
+
+    bool IsBinaryMap(const uint8_t* data, size_t size) {
+        return data && size >= sizeof(BinaryMapHeader) && std::memcmp(data, kMapMagic, sizeof(kMapMagic)) == 0;
+    }
+
+    void WriteBinaryMap(const MapData& map_data, std::vector<uint8_t>& out_data) {
+        const VisibilityGraph& graph = map_data.visibility_graph;
+
+        std::vector<BinaryTravelPortal> portals;
+        std::vector<PortalConnection> connections;
+        portals.reserve(map_data.travel_portals.size());
+        for (const auto& portal : map_data.travel_portals) {
+            portals.push_back({ portal.position, static_cast<uint32_t>(connections.size()),
+                                static_cast<uint32_t>(portal.connections.size()) });
+            connections.insert(connections.end(), portal.connections.begin(), portal.connections.end());
+        }
+
+        BinaryMapHeader header = {};
+        std::memcpy(header.magic, kMapMagic, sizeof(kMapMagic));
+        header.version = kBinaryMapVersion;
+        header.map_id = map_data.map_id;
+        header.point_count = static_cast<uint32_t>(map_data.points.size());
+        header.edge_count = static_cast<uint32_t>(graph.EdgeCount());
+        header.blocking_edge_count = static_cast<uint32_t>(graph.blocking_edges.size());
+        header.blocking_layer_count = static_cast<uint32_t>(graph.blocking_layers.size());
+        header.trapezoid_count = static_cast<uint32_t>(map_data.trapezoids.size());
+        header.teleporter_count = static_cast<uint32_t>(map_data.teleporters.size());
+        header.travel_portal_count = static_cast<uint32_t>(portals.size());
+        header.portal_connection_count = static_cast<uint32_t>(connections.size());
+        header.npc_travel_count = static_cast<uint32_t>(map_data.npc_travels.size());
+        header.enter_travel_count = static_cast<uint32_t>(map_data.enter_travels.size());
+        const ContractionHierarchy& ch = map_data.contraction_hierarchy;
+        header.ch_node_count = static_cast<uint32_t>(ch.NodeCount());
+        header.ch_up_edge_count = static_cast<uint32_t>(ch.up_targets.size());
+        header.ch_down_edge_count = static_cast<uint32_t>(ch.down_sources.size());
+        const LandmarkTable& landmarks = map_data.landmarks;
+        header.landmark_count = static_cast<uint32_t>(landmarks.count);
+        header.landmark_directed = landmarks.IsSymmetric() ? 0 : 1;
+        const TravelCostTable& travel_costs = map_data.travel_costs;
+        header.travel_arrival_count = static_cast<uint32_t>(travel_costs.arrivals.size());
+        header.travel_cost_count = static_cast<uint32_t>(travel_costs.costs.size());
+        header.stats = map_data.stats;
+
+        // Offsets always have point_count + 1 entries, even for a graph without rows
+        std::vector<uint32_t> offsets = graph.offsets;
+        offsets.resize(map_data.points.size() + 1, offsets.empty() ? 0 : offsets.back());
+        std::vector<uint32_t> blocking_offsets = graph.blocking_offsets;
+        blocking_offsets.resize(graph.blocking_edges.size() + 1, blocking_offsets.empty() ? 0 : blocking_offsets.back());
+
+        out_data.clear();
+        AppendArray(out_data, &header, 1);
+        AppendArray(out_data, map_data.points.data(), map_data.points.size());
+        AppendArray(out_data, offsets.data(), offsets.size());
+        AppendArray(out_data, graph.targets.data(), graph.targets.size());
+        AppendArray(out_data, graph.distances.data(), graph.distances.size());
+        AppendArray(out_data, graph.blocking_edges.data(), graph.blocking_edges.size());
+        AppendArray(out_data, blocking_offsets.data(), blocking_offsets.size());
+        AppendArray(out_data, graph.blocking_layers.data(), graph.blocking_layers.size());
+        AppendArray(out_data, map_data.trapezoids.data(), map_data.trapezoids.size());
+        AppendArray(out_data, map_data.teleporters.data(), map_data.teleporters.size());
+        AppendArray(out_data, portals.data(), portals.size());
+        AppendArray(out_data, connections.data(), connections.size());
+        AppendArray(out_data, map_data.npc_travels.data(), map_data.npc_travels.size());
+        AppendArray(out_data, map_data.enter_travels.data(), map_data.enter_travels.size());
+
+        if (!ch.Empty()) {
+            AppendArray(out_data, ch.ranks.data(), ch.ranks.size());
+            AppendArray(out_data, ch.up_offsets.data(), ch.up_offsets.size());
+            AppendArray(out_data, ch.up_targets.data(), ch.up_targets.size());
+            AppendArray(out_data, ch.up_weights.data(), ch.up_weights.size());
+            AppendArray(out_data, ch.up_middles.data(), ch.up_middles.size());
+            AppendArray(out_data, ch.down_offsets.data(), ch.down_offsets.size());
+            AppendArray(out_data, ch.down_sources.data(), ch.down_sources.size());
+            AppendArray(out_data, ch.down_weights.data(), ch.down_weights.size());
+            AppendArray(out_data, ch.down_middles.data(), ch.down_middles.size());
+        }
+
+        if (!landmarks.Empty()) {
+            AppendArray(out_data, landmarks.landmarks.data(), landmarks.landmarks.size());
+            AppendArray(out_data, landmarks.from_distances.data(), landmarks.from_distances.size());
+            AppendArray(out_data, landmarks.to_distances.data(), landmarks.to_distances.size());
+        }
+
+        AppendArray(out_data, travel_costs.arrivals.data(), travel_costs.arrivals.size());
+        AppendArray(out_data, travel_costs.costs.data(), travel_costs.costs.size());
+    }
+
+    bool ReadBinaryMap(const uint8_t* data, size_t size, MapData& out_map_data) {
+        BinaryMapHeader header;
+        if (!ReadHeader(data, size, header)) {
+            return false;
+        }
+
+        BinaryReader reader(data + sizeof(header), size - sizeof(header));
+        VisibilityGraph& graph = out_map_data.visibility_graph;
+        std::vector<BinaryTravelPortal> portals;
+        std::vector<PortalConnection> connections;
+
+        bool ok = reader.ReadArray(out_map_data.points, header.point_count)
+            && reader.ReadArray(graph.offsets, static_cast<size_t>(header.point_count) + 1)
+            && reader.ReadArray(graph.targets, header.edge_count)
+            && reader.ReadArray(graph.distances, header.edge_count)
+            && reader.ReadArray(graph.blocking_edges, header.blocking_edge_count)
+            && reader.ReadArray(graph.blocking_offsets, static_cast<size_t>(header.blocking_edge_count) + 1)
+            && reader.ReadArray(graph.blocking_layers, header.blocking_layer_count)
+            && reader.ReadArray(out_map_data.trapezoids, header.trapezoid_count)
+            && reader.ReadArray(out_map_data.teleporters, header.teleporter_count)
+            && ReadTravelSections(reader, header, portals, connections, out_map_data);
+        if (!ok) {
+            return false;
+        }
+
+        ContractionHierarchy& ch = out_map_data.contraction_hierarchy;
+        ch.Clear();
+        if (header.ch_node_count > 0) {
+            const size_t row_count = static_cast<size_t>(header.ch_node_count) + 1;
+            ok = header.ch_node_count == header.point_count
+                && reader.ReadArray(ch.ranks, header.ch_node_count)
+                && reader.ReadArray(ch.up_offsets, row_count)
+                && reader.ReadArray(ch.up_targets, header.ch_up_edge_count)
+                && reader.ReadArray(ch.up_weights, header.ch_up_edge_count)
+                && reader.ReadArray(ch.up_middles, header.ch_up_edge_count)
+                && reader.ReadArray(ch.down_offsets, row_count)
+                && reader.ReadArray(ch.down_sources, header.ch_down_edge_count)
+                && reader.ReadArray(ch.down_weights, header.ch_down_edge_count)
+                && reader.ReadArray(ch.down_middles, header.ch_down_edge_count)
+                && ch.IsValid(static_cast<int32_t>(header.point_count));
+            if (!ok) {
+                return false;
+            }
+        }
+
+        LandmarkTable& landmarks = out_map_data.landmarks;
+        landmarks.Clear();
+        if (header.landmark_count > 0) {
+            const size_t table_size = static_cast<size_t>(header.point_count) * header.landmark_count;
+            landmarks.count = header.landmark_count <= static_cast<uint32_t>(kMaxLandmarks) ? static_cast<int32_t>(header.landmark_count) : 0;
+            ok = landmarks.count > 0
+                && reader.ReadArray(landmarks.landmarks, header.landmark_count)
+                && reader.ReadArray(landmarks.from_distances, table_size)
+                && reader.ReadArray(landmarks.to_distances, header.landmark_directed ? table_size : 0)
+                && landmarks.IsValid(static_cast<int32_t>(header.point_count));
+            if (!ok) {
+                return false;
+            }
+        }
+
+        if (!ReadTravelCosts(reader, header, out_map_data)) {
+            return false;
+        }
+
+        // The search trusts the CSR arrays, so reject anything inconsistent
+        if (graph.offsets.front() != 0 || graph.offsets.back() != header.edge_count) {
+            return false;
+        }
+        for (size_t i = 1; i < graph.offsets.size(); ++i) {
+            if (graph.offsets[i] < graph.offsets[i - 1]) {
+                return false;
+            }
+        }
+        for (int32_t target : graph.targets) {
+            if (target < 0 || static_cast<uint32_t>(target) >= header.point_count) {
+                return false;
+            }
+        }
+
+        if (!FinishTravelData(portals, connections, out_map_data)) {
+            return false;
+        }
+
+        out_map_data.map_id = header.map_id;
+        out_map_data.stats = header.stats;
+        return true;
+    }
+
+    bool ReadBinaryTravelData(const uint8_t* data, size_t size, MapData& out_map_data) {
+        BinaryMapHeader header;
+        if (!ReadHeader(data, size, header)) {
+            return false;
+        }
+
+        BinaryReader reader(data + sizeof(header), size - sizeof(header));
+        const size_t row_count = static_cast<size_t>(header.point_count) + 1;
+        const size_t ch_row_count = header.ch_node_count > 0 ? static_cast<size_t>(header.ch_node_count) + 1 : 0;
+        const size_t table_size = static_cast<size_t>(header.point_count) * header.landmark_count;
+        std::vector<BinaryTravelPortal> portals;
+        std::vector<PortalConnection> connections;
+
+        bool ok = reader.SkipArray<Point>(header.point_count)
+            && reader.SkipArray<uint32_t>(row_count)
+            && reader.SkipArray<int32_t>(header.edge_count)
+            && reader.SkipArray<float>(header.edge_count)
+            && reader.SkipArray<uint32_t>(header.blocking_edge_count)
+            && reader.SkipArray<uint32_t>(static_cast<size_t>(header.blocking_edge_count) + 1)
+            && reader.SkipArray<uint32_t>(header.blocking_layer_count)
+            && reader.SkipArray<Trapezoid>(header.trapezoid_count)
+            && reader.SkipArray<Teleporter>(header.teleporter_count)
+            && ReadTravelSections(reader, header, portals, connections, out_map_data)
+            && reader.SkipArray<int32_t>(header.ch_node_count)
+            && reader.SkipArray<uint32_t>(ch_row_count)
+            && reader.SkipArray<int32_t>(header.ch_up_edge_count)
+            && reader.SkipArray<float>(header.ch_up_edge_count)
+            && reader.SkipArray<int32_t>(header.ch_up_edge_count)
+            && reader.SkipArray<uint32_t>(ch_row_count)
+            && reader.SkipArray<int32_t>(header.ch_down_edge_count)
+            && reader.SkipArray<float>(header.ch_down_edge_count)
+            && reader.SkipArray<int32_t>(header.ch_down_edge_count)
+            && reader.SkipArray<int32_t>(header.landmark_count)
+            && reader.SkipArray<float>(header.landmark_count > 0 ? table_size : 0)
+            && reader.SkipArray<float>(header.landmark_count > 0 && header.landmark_directed ? table_size : 0)
+            && ReadTravelCosts(reader, header, out_map_data)
+            && FinishTravelData(portals, connections, out_map_data);
+        if (!ok) {
+            return false;
+        }
+
+        out_map_data.map_id = header.map_id;
+        out_map_data.stats = header.stats;
+        return true;
+    }
+
+    bool WriteBinaryPack(const std::string& path, const std::vector<std::pair<int32_t, std::vector<uint8_t>>>& maps) {
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        BinaryPackHeader header = {};
+        std::memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+        header.version = kBinaryMapVersion;
+        header.map_count = static_cast<uint32_t>(maps.size());
+
+        // Map blobs follow the directory, each aligned to 8 bytes
+        std::vector<BinaryPackEntry> directory;
+        uint64_t offset = sizeof(BinaryPackHeader) + maps.size() * sizeof(BinaryPackEntry);
+        for (const auto& map : maps) {
+            BinaryPackEntry entry;
+            entry.map_id = map.first;
+            entry.reserved = 0;
+            entry.offset = offset;
+            entry.size = map.second.size();
+            directory.push_back(entry);
+            offset += (entry.size + 7) & ~static_cast<uint64_t>(7);
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(directory.data()),
+                   static_cast<std::streamsize>(directory.size() * sizeof(BinaryPackEntry)));
+
+        const char padding[8] = {};
+        for (const auto& map : maps) {
+            file.write(reinterpret_cast<const char*>(map.second.data()), static_cast<std::streamsize>(map.second.size()));
+            size_t pad = ((map.second.size() + 7) & ~static_cast<size_t>(7)) - map.second.size();
+            file.write(padding, static_cast<std::streamsize>(pad));
+        }
+
+        return file.good();
+    }
+
+    // ==================== MappedFile Implementation ====================
+
+    MappedFile::MappedFile()
+        : m_data(nullptr)
+        , m_size(0)
+#ifdef _WIN32
+        , m_file_handle(nullptr)
+        , m_mapping_handle(nullptr)
+#endif
+    {
+    }
+
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+    bool MappedFile::Open(const std::string& path) {
+        Close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping) {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file_handle = file;
+        m_mapping_handle = mapping;
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(file_size.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (!m_data) {
+            return;
+        }
+
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_mapping_handle));
+        CloseHandle(static_cast<HANDLE>(m_file_handle));
+        m_mapping_handle = nullptr;
+        m_file_handle = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    // ==================== BinaryMapPack Implementation ====================
+
+    bool BinaryMapPack::Open(const std::string& path) {
+        Close();
+
+        if (!m_file.Open(path)) {
+            return false;
+        }
+
+        const uint8_t* data = m_file.Data();
+        const size_t size = m_file.Size();
+
+        BinaryPackHeader header;
+        if (size < sizeof(header)) {
+            Close();
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+
+        if (std::memcmp(header.magic, kPackMagic, sizeof(kPackMagic)) != 0 ||
+            header.version != kBinaryMapVersion ||
+            header.map_count > (size - sizeof(header)) / sizeof(BinaryPackEntry)) {
+            Close();
+            return false;
+        }
+
+        for (uint32_t i = 0; i < header.map_count; ++i) {
+            BinaryPackEntry entry;
+            std::memcpy(&entry, data + sizeof(header) + i * sizeof(BinaryPackEntry), sizeof(entry));
+
+            // Ignore entries pointing outside the file
+            if (entry.offset > size || entry.size > size - entry.offset) {
+                continue;
+            }
+            m_directory[entry.map_id] = entry;
+        }
+
+        return true;
+    }
+
+    void BinaryMapPack::Close() {
+        m_directory.clear();
+        m_file.Close();
+    }
+
+    bool BinaryMapPack::GetMap(int32_t map_id, const uint8_t*& out_data, size_t& out_size) const {
+        auto it = m_directory.find(map_id);
+        if (it == m_directory.end()) {
+            return false;
+        }
+
+        out_data = m_file.Data() + it->second.offset;
+        out_size = static_cast<size_t>(it->second.size);
+        return true;
+    }
+
+    bool BinaryMapPack::HasMap(int32_t map_id) const {
+        return m_directory.find(map_id) != m_directory.end();
+    }
+
+    std::vector<int32_t> BinaryMapPack::GetMapIds() const {
+        std::vector<int32_t> ids;
+        ids.reserve(m_directory.size());
+        for (const auto& entry : m_directory) {
+            ids.push_back(entry.first);
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+} // namespace Pathfinder
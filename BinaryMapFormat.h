@@ -0,0 +1,164 @@
+#pragma once
+
+#include "PathfinderCore.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace Pathfinder {
+
+    /**
+     * @brief Precompiled binary navigation format
+     *
+     * A baked map is a fixed header followed by raw, 4-byte aligned arrays that are copied
+     * straight into MapData (points, CSR edges, trapezoids, teleporters, portals, NPC/Enter travel,
+     * landmark tables, travel costs and optionally the contraction hierarchy).
+     * Several maps are stored in a single pack file (maps.nav) with a directory, which is
+     * memory-mapped once so loading a map is a handful of memcpy calls instead of a JSON parse.
+     *
+     * Layout is little-endian, as produced and consumed on x86 Windows.
+     * Bump kBinaryMapVersion whenever the layout or the semantics of a section change.
+     */
+    constexpr uint32_t kBinaryMapVersion = 6;
+
+    // Header of a single baked map
+    struct BinaryMapHeader {
+        char magic[4];                      // "GWNM"
+        uint32_t version;                   // kBinaryMapVersion
+        int32_t map_id;
+        uint32_t point_count;
+        uint32_t edge_count;
+        uint32_t blocking_edge_count;
+        uint32_t blocking_layer_count;
+        uint32_t trapezoid_count;
+        uint32_t teleporter_count;
+        uint32_t travel_portal_count;
+        uint32_t portal_connection_count;
+        uint32_t npc_travel_count;
+        uint32_t enter_travel_count;
+        uint32_t ch_node_count;             // 0 = no contraction hierarchy, point_count otherwise
+        uint32_t ch_up_edge_count;
+        uint32_t ch_down_edge_count;
+        uint32_t landmark_count;            // 0 = no landmark tables (built at load)
+        uint32_t landmark_directed;         // 1 = separate to-landmark table (directed graph)
+        uint32_t travel_arrival_count;      // 0 = no travel cost table
+        uint32_t travel_cost_count;         // travel_arrival_count x transition count
+        MapStatistics stats;
+    };
+
+    // Header of a pack file, followed by map_count directory entries
+    struct BinaryPackHeader {
+        char magic[4];                      // "GWNP"
+        uint32_t version;                   // kBinaryMapVersion
+        uint32_t map_count;
+        uint32_t reserved;
+    };
+
+    // Directory entry of a pack file
+    struct BinaryPackEntry {
+        int32_t map_id;
+        uint32_t reserved;
+        uint64_t offset;                    // From the start of the pack
+        uint64_t size;
+    };
+
+    /**
+     * @brief Serializes a loaded map into the binary format
+     * @param map_data Map to serialize
+     * @param out_data Receives the baked bytes
+     */
+    void WriteBinaryMap(const MapData& map_data, std::vector<uint8_t>& out_data);
+
+    /**
+     * @brief Loads a baked map into MapData (spatial indexes are not built)
+     * @param data Pointer to the baked bytes
+     * @param size Number of bytes available
+     * @param out_map_data Receives the map
+     * @return true if the data is a valid baked map of the current version
+     */
+    bool ReadBinaryMap(const uint8_t* data, size_t size, MapData& out_map_data);
+
+    /**
+     * @brief Loads only the travel data of a baked map: portals, NPC / Enter travel and travel costs
+     *
+     * Skips the geometry and the search tables, for callers that only need how maps link together.
+     * @return true if the data is a valid baked map of the current version
+     */
+    bool ReadBinaryTravelData(const uint8_t* data, size_t size, MapData& out_map_data);
+
+    /**
+     * @brief Checks whether a buffer starts with a baked map header
+     */
+    bool IsBinaryMap(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Writes a pack file containing several baked maps
+     * @param path Output file path
+     * @param maps Baked maps (map_id -> bytes)
+     * @return true if the file was written
+     */
+    bool WriteBinaryPack(const std::string& path, const std::vector<std::pair<int32_t, std::vector<uint8_t>>>& maps);
+
+    /**
+     * @brief Read-only memory mapping of a whole file
+     */
+    class MappedFile {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        bool Open(const std::string& path);
+        void Close();
+
+        bool IsOpen() const { return m_data != nullptr; }
+        const uint8_t* Data() const { return m_data; }
+        size_t Size() const { return m_size; }
+
+        // Disallow copying
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+#ifdef _WIN32
+        void* m_file_handle;
+        void* m_mapping_handle;
+#endif
+    };
+
+    /**
+     * @brief Memory-mapped pack of baked maps (maps.nav)
+     *
+     * The directory is read once at open; map bytes are served directly from the mapping.
+     */
+    class BinaryMapPack {
+    public:
+        /**
+         * @brief Memory-maps a pack file and reads its directory
+         * @param path Path to the pack file
+         * @return true if the pack is valid and of the current version
+         */
+        bool Open(const std::string& path);
+
+        void Close();
+
+        bool IsOpen() const { return m_file.IsOpen(); }
+
+        /**
+         * @brief Returns the baked bytes of a map (pointer into the mapping)
+         * @return true if the map is in the pack
+         */
+        bool GetMap(int32_t map_id, const uint8_t*& out_data, size_t& out_size) const;
+
+        bool HasMap(int32_t map_id) const;
+
+        std::vector<int32_t> GetMapIds() const;
+
+    private:
+        MappedFile m_file;
+        std::unordered_map<int32_t, BinaryPackEntry> m_directory;
+    };
+
+} // namespace Pathfinder
@@ -0,0 +1,123 @@
+#include "ComponentIndex.h"
+#include <algorithm>
+#include <utility>
+
+namespace Pathfinder {
+
+    size_t ComponentIndex::MemoryUsage() const {
+        return components.capacity() * sizeof(int32_t)
+            + dag_offsets.capacity() * sizeof(uint32_t)
+            + dag_targets.capacity() * sizeof(int32_t);
+    }
+
+    void ComponentIndex::Build(int32_t node_count, const uint32_t* offsets, const int32_t* targets) {
+        Clear();
+        if (node_count <= 0) {
+            return;
+        }
+
+        // Iterative Tarjan: order[v] is the discovery order of v, low[v] the lowest order it reaches
+        // among the nodes still on the stack; a node whose low is its own order closes a component
+        components.assign(node_count, -1);
+        std::vector<int32_t> order(node_count, -1);
+        std::vector<int32_t> low(node_count, 0);
+        std::vector<int32_t> stack;
+        std::vector<std::pair<int32_t, uint32_t>> calls; // (node, next edge to visit)
+        int32_t next_order = 0;
+        int32_t component_count = 0;
+
+        for (int32_t root = 0; root < node_count; ++root) {
+            if (order[root] >= 0) {
+                continue;
+            }
+
+            order[root] = low[root] = next_order++;
+            stack.push_back(root);
+            calls.emplace_back(root, offsets[root]);
+            while (!calls.empty()) {
+                const int32_t node = calls.back().first;
+                uint32_t& edge = calls.back().second;
+                if (edge < offsets[node + 1]) {
+                    const int32_t target = targets[edge++];
+                    if (order[target] < 0) {
+                        order[target] = low[target] = next_order++;
+                        stack.push_back(target);
+                        calls.emplace_back(target, offsets[target]);
+                    }
+                    else if (components[target] < 0) {
+                        low[node] = std::min(low[node], order[target]); // Still on the stack
+                    }
+                    continue;
+                }
+
+                calls.pop_back();
+                if (!calls.empty()) {
+                    low[calls.back().first] = std::min(low[calls.back().first], low[node]);
+                }
+                if (low[node] == order[node]) {
+                    int32_t member;
+                    do {
+                        member = stack.back();
+                        stack.pop_back();
+                        components[member] = component_count;
+                    } while (member != node);
+                    ++component_count;
+                }
+            }
+        }
+
+        // Condensation: the distinct edges between components
+        std::vector<std::pair<int32_t, int32_t>> links;
+        for (int32_t node = 0; node < node_count; ++node) {
+            for (uint32_t e = offsets[node]; e < offsets[node + 1]; ++e) {
+                if (components[targets[e]] != components[node]) {
+                    links.emplace_back(components[node], components[targets[e]]);
+                }
+            }
+        }
+        std::sort(links.begin(), links.end());
+        links.erase(std::unique(links.begin(), links.end()), links.end());
+
+        dag_offsets.assign(component_count + 1, 0);
+        dag_targets.reserve(links.size());
+        for (const auto& link : links) {
+            ++dag_offsets[link.first + 1];
+            dag_targets.push_back(link.second);
+        }
+        for (int32_t c = 0; c < component_count; ++c) {
+            dag_offsets[c + 1] += dag_offsets[c];
+        }
+    }
+
+    void ComponentIndex::MarkReached(int32_t from, ComponentMarks& marks) const {
+        if (marks.IsMarked(from)) {
+            return;
+        }
+
+        marks.Mark(from);
+        if (dag_targets.empty()) {
+            return;
+        }
+
+        marks.pending.clear();
+        marks.pending.push_back(from);
+        while (!marks.pending.empty()) {
+            const int32_t component = marks.pending.back();
+            marks.pending.pop_back();
+            for (uint32_t e = dag_offsets[component]; e < dag_offsets[component + 1]; ++e) {
+                const int32_t target = dag_targets[e];
+                if (!marks.IsMarked(target)) {
+                    marks.Mark(target);
+                    marks.pending.push_back(target);
+                }
+            }
+        }
+    }
+
+    void ComponentIndex::Clear() {
+        components.clear();
+        dag_offsets.clear();
+        dag_targets.clear();
+    }
+
+} // namespace Pathfinder
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pathfinder {
+
+    /**
+     * @brief Components marked by ComponentIndex::MarkReached, reusable across walks and graphs
+     *
+     * A component is marked when its stamp equals the current generation, so starting a new set
+     * of marks does not clear the stamps.
+     */
+    struct ComponentMarks {
+        std::vector<uint32_t> stamps;           // Generation that last marked each component
+        std::vector<int32_t> pending;           // Components left to walk
+        uint32_t generation = 0;
+
+        // Unmarks every component, growing the stamps to component_count
+        void Begin(int32_t component_count) {
+            if (stamps.size() < static_cast<size_t>(component_count)) {
+                stamps.resize(component_count, 0);
+            }
+            if (++generation == 0) {
+                std::fill(stamps.begin(), stamps.end(), 0);
+                generation = 1;
+            }
+        }
+
+        bool IsMarked(int32_t component) const {
+            return stamps[component] == generation;
+        }
+
+        void Mark(int32_t component) {
+            stamps[component] = generation;
+        }
+    };
+
+    /**
+     * @brief Strongly connected components of a graph, for constant-time reachability
+     *
+     * Two nodes of the same component reach each other. Components are numbered in reverse
+     * topological order (Tarjan): an edge between two components always goes to the lower
+     * number, so a node can only reach components numbered at most as its own. The edges between
+     * components (the condensation) are kept for the rare directed graphs (one-way teleporters);
+     * on a symmetric graph there are none and MarkReached marks a single component.
+     */
+    struct ComponentIndex {
+        std::vector<int32_t> components;        // Component of each node
+        std::vector<uint32_t> dag_offsets;      // CSR rows of the edges leaving each component (plus the end)
+        std::vector<int32_t> dag_targets;       // Target component, unique per row
+
+        bool Empty() const {
+            return components.empty();
+        }
+
+        int32_t NodeCount() const {
+            return static_cast<int32_t>(components.size());
+        }
+
+        int32_t ComponentCount() const {
+            return dag_offsets.empty() ? 0 : static_cast<int32_t>(dag_offsets.size()) - 1;
+        }
+
+        // Heap size in bytes
+        size_t MemoryUsage() const;
+
+        /**
+         * @brief Labels the components of a graph given in CSR layout (replaces any previous labelling)
+         * @param node_count Number of nodes
+         * @param offsets node_count + 1 row offsets
+         * @param targets Target node of each edge
+         */
+        void Build(int32_t node_count, const uint32_t* offsets, const int32_t* targets);
+
+        /**
+         * @brief Marks a component and every component a path leads to from it
+         * Walks the condensation, skipping the components already marked since marks.Begin.
+         */
+        void MarkReached(int32_t from, ComponentMarks& marks) const;
+
+        void Clear();
+    };
+
+} // namespace Pathfinder
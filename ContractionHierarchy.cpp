@@ -0,0 +1,405 @@
+#include "ContractionHierarchy.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace Pathfinder {
+
+    namespace {
+
+        // Witness searches give up past this many settled nodes; a missed witness only costs a
+        // superfluous shortcut, never a wrong distance
+        const int32_t kWitnessSettleLimit = 500;
+
+        struct Arc {
+            int32_t node;       // Other end of the edge
+            float weight;
+            int32_t middle;     // -1 = edge of the original graph
+        };
+
+        struct Shortcut {
+            int32_t from;
+            int32_t to;
+            float weight;
+        };
+
+        // Edge lists of a graph being contracted
+        class Contractor {
+        public:
+            Contractor(int32_t node_count, const uint32_t* offsets, const int32_t* targets, const float* weights)
+                : m_out(node_count)
+                , m_in(node_count)
+                , m_deleted_neighbours(node_count, 0)
+                , m_distances(node_count, std::numeric_limits<float>::infinity())
+                , m_stamps(node_count, 0)
+                , m_target_stamps(node_count, 0)
+                , m_generation(0) {
+                for (int32_t from = 0; from < node_count; ++from) {
+                    for (uint32_t e = offsets[from]; e < offsets[from + 1]; ++e) {
+                        if (targets[e] != from) {
+                            AddEdge(from, targets[e], weights[e], -1);
+                        }
+                    }
+                }
+            }
+
+            void Run(ContractionHierarchy& out) {
+                const int32_t node_count = static_cast<int32_t>(m_out.size());
+
+                // Lazy updates: a node whose priority went up since it was queued is queued again
+                using QueueEntry = std::pair<int32_t, int32_t>;     // (priority, node)
+                std::vector<QueueEntry> queue;
+                queue.reserve(node_count);
+                for (int32_t node = 0; node < node_count; ++node) {
+                    queue.emplace_back(Priority(node), node);
+                }
+                const std::greater<QueueEntry> queue_order;
+                std::make_heap(queue.begin(), queue.end(), queue_order);
+
+                std::vector<std::vector<Arc>> up(node_count);
+                std::vector<std::vector<Arc>> down(node_count);
+                out.ranks.assign(node_count, -1);
+                int32_t next_rank = 0;
+
+                while (!queue.empty()) {
+                    std::pop_heap(queue.begin(), queue.end(), queue_order);
+                    const int32_t node = queue.back().second;
+                    queue.pop_back();
+
+                    const int32_t priority = Priority(node);
+                    if (!queue.empty() && priority > queue.front().first) {
+                        queue.emplace_back(priority, node);
+                        std::push_heap(queue.begin(), queue.end(), queue_order);
+                        continue;
+                    }
+
+                    // Every remaining neighbour will be ranked higher
+                    // The shortcuts listed by Priority are still current: nothing changed since
+                    out.ranks[node] = next_rank++;
+                    up[node] = m_out[node];
+                    down[node] = m_in[node];
+                    Contract(node);
+                }
+
+                Flatten(up, out.up_offsets, out.up_targets, out.up_weights, out.up_middles);
+                Flatten(down, out.down_offsets, out.down_sources, out.down_weights, out.down_middles);
+            }
+
+        private:
+            // Adds an edge, or lowers the weight of the existing one
+            void AddEdge(int32_t from, int32_t to, float weight, int32_t middle) {
+                for (Arc& arc : m_out[from]) {
+                    if (arc.node == to) {
+                        if (weight < arc.weight) {
+                            arc.weight = weight;
+                            arc.middle = middle;
+                            for (Arc& reverse : m_in[to]) {
+                                if (reverse.node == from) {
+                                    reverse.weight = weight;
+                                    reverse.middle = middle;
+                                    break;
+                                }
+                            }
+                        }
+                        return;
+                    }
+                }
+
+                m_out[from].push_back({ to, weight, middle });
+                m_in[to].push_back({ from, weight, middle });
+            }
+
+            static void RemoveArc(std::vector<Arc>& arcs, int32_t node) {
+                for (size_t i = 0; i < arcs.size(); ++i) {
+                    if (arcs[i].node == node) {
+                        arcs[i] = arcs.back();
+                        arcs.pop_back();
+                        return;
+                    }
+                }
+            }
+
+            // Edge difference, plus the neighbours already contracted to spread contraction evenly
+            int32_t Priority(int32_t node) {
+                FindShortcuts(node, m_shortcuts);
+                const int32_t removed = static_cast<int32_t>(m_in[node].size() + m_out[node].size());
+                return static_cast<int32_t>(m_shortcuts.size()) - removed + m_deleted_neighbours[node];
+            }
+
+            // Removes a node, adding the shortcuts listed by the last Priority call on it
+            void Contract(int32_t node) {
+                for (const Arc& arc : m_out[node]) {
+                    RemoveArc(m_in[arc.node], node);
+                    m_deleted_neighbours[arc.node]++;
+                }
+                for (const Arc& arc : m_in[node]) {
+                    RemoveArc(m_out[arc.node], node);
+                    m_deleted_neighbours[arc.node]++;
+                }
+                std::vector<Arc>().swap(m_out[node]);
+                std::vector<Arc>().swap(m_in[node]);
+
+                for (const Shortcut& shortcut : m_shortcuts) {
+                    AddEdge(shortcut.from, shortcut.to, shortcut.weight, node);
+                }
+            }
+
+            // Lists the shortcuts needed to contract a node: u -> node -> w unless a path u -> w
+            // of at most the same length avoids the node
+            void FindShortcuts(int32_t node, std::vector<Shortcut>& out_shortcuts) {
+                out_shortcuts.clear();
+
+                for (const Arc& in : m_in[node]) {
+                    NewSearch();
+
+                    float max_distance = 0.0f;
+                    int32_t target_count = 0;
+                    for (const Arc& out : m_out[node]) {
+                        if (out.node != in.node) {
+                            max_distance = std::max(max_distance, in.weight + out.weight);
+                            m_target_stamps[out.node] = m_generation;
+                            target_count++;
+                        }
+                    }
+                    if (target_count == 0) {
+                        continue;
+                    }
+
+                    WitnessSearch(in.node, node, max_distance, target_count);
+
+                    for (const Arc& out : m_out[node]) {
+                        const float through = in.weight + out.weight;
+                        if (out.node != in.node && Distance(out.node) > through) {
+                            out_shortcuts.push_back({ in.node, out.node, through });
+                        }
+                    }
+                }
+            }
+
+            // Invalidates the distances and targets of the previous witness search
+            void NewSearch() {
+                if (++m_generation == 0) {
+                    std::fill(m_stamps.begin(), m_stamps.end(), 0u);
+                    std::fill(m_target_stamps.begin(), m_target_stamps.end(), 0u);
+                    m_generation = 1;
+                }
+            }
+
+            // Bounded Dijkstra from source over the remaining graph, never entering the excluded node
+            // Stops once the target_count nodes marked as targets are settled
+            void WitnessSearch(int32_t source, int32_t excluded, float max_distance, int32_t target_count) {
+                using HeapEntry = std::pair<float, int32_t>;
+                const std::greater<HeapEntry> heap_order;
+                m_heap.clear();
+                SetDistance(source, 0.0f);
+                m_heap.emplace_back(0.0f, source);
+
+                int32_t settled = 0;
+                while (!m_heap.empty()) {
+                    std::pop_heap(m_heap.begin(), m_heap.end(), heap_order);
+                    const HeapEntry current = m_heap.back();
+                    m_heap.pop_back();
+
+                    if (current.first > Distance(current.second)) {
+                        continue; // Stale entry
+                    }
+                    if (current.first > max_distance || ++settled > kWitnessSettleLimit) {
+                        break;
+                    }
+                    if (m_target_stamps[current.second] == m_generation && --target_count == 0) {
+                        break;
+                    }
+
+                    for (const Arc& arc : m_out[current.second]) {
+                        if (arc.node == excluded) {
+                            continue;
+                        }
+
+                        const float distance = current.first + arc.weight;
+                        if (distance < Distance(arc.node)) {
+                            SetDistance(arc.node, distance);
+                            m_heap.emplace_back(distance, arc.node);
+                            std::push_heap(m_heap.begin(), m_heap.end(), heap_order);
+                        }
+                    }
+                }
+            }
+
+            float Distance(int32_t node) const {
+                return m_stamps[node] == m_generation ? m_distances[node] : std::numeric_limits<float>::infinity();
+            }
+
+            void SetDistance(int32_t node, float distance) {
+                m_stamps[node] = m_generation;
+                m_distances[node] = distance;
+            }
+
+            static void Flatten(const std::vector<std::vector<Arc>>& rows, std::vector<uint32_t>& offsets,
+                                std::vector<int32_t>& nodes, std::vector<float>& weights, std::vector<int32_t>& middles) {
+                size_t total = 0;
+                for (const auto& row : rows) {
+                    total += row.size();
+                }
+
+                offsets.clear();
+                nodes.clear();
+                weights.clear();
+                middles.clear();
+                offsets.reserve(rows.size() + 1);
+                nodes.reserve(total);
+                weights.reserve(total);
+                middles.reserve(total);
+
+                offsets.push_back(0);
+                for (const auto& row : rows) {
+                    for (const Arc& arc : row) {
+                        nodes.push_back(arc.node);
+                        weights.push_back(arc.weight);
+                        middles.push_back(arc.middle);
+                    }
+                    offsets.push_back(static_cast<uint32_t>(nodes.size()));
+                }
+            }
+
+            std::vector<std::vector<Arc>> m_out;
+            std::vector<std::vector<Arc>> m_in;
+            std::vector<int32_t> m_deleted_neighbours;
+            std::vector<Shortcut> m_shortcuts;
+
+            // Witness search state, reset in O(1) by bumping the generation
+            std::vector<float> m_distances;
+            std::vector<uint32_t> m_stamps;
+            std::vector<uint32_t> m_target_stamps;
+            uint32_t m_generation;
+            std::vector<std::pair<float, int32_t>> m_heap;
+        };
+
+        template <typename T>
+        size_t VectorBytes(const std::vector<T>& items) {
+            return items.capacity() * sizeof(T);
+        }
+
+        // Checks one direction: CSR shape, ends ranked above the row, middles ranked below both ends
+        bool IsValidSide(const ContractionHierarchy& ch, const std::vector<uint32_t>& offsets,
+                         const std::vector<int32_t>& nodes, const std::vector<float>& weights,
+                         const std::vector<int32_t>& middles) {
+            const size_t node_count = ch.ranks.size();
+            if (offsets.size() != node_count + 1 || offsets.front() != 0 || offsets.back() != nodes.size()
+                || weights.size() != nodes.size() || middles.size() != nodes.size()) {
+                return false;
+            }
+
+            for (size_t row = 0; row < node_count; ++row) {
+                if (offsets[row + 1] < offsets[row]) {
+                    return false;
+                }
+
+                for (uint32_t e = offsets[row]; e < offsets[row + 1]; ++e) {
+                    const int32_t other = nodes[e];
+                    const int32_t middle = middles[e];
+                    if (other < 0 || static_cast<size_t>(other) >= node_count || ch.ranks[other] <= ch.ranks[row]
+                        || !(weights[e] >= 0.0f)) {
+                        return false;
+                    }
+                    if (middle != -1 && (middle < 0 || static_cast<size_t>(middle) >= node_count
+                        || ch.ranks[middle] >= ch.ranks[row])) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+    } // namespace
+
+    size_t ContractionHierarchy::MemoryUsage() const {
+        return VectorBytes(ranks)
+            + VectorBytes(up_offsets) + VectorBytes(up_targets) + VectorBytes(up_weights) + VectorBytes(up_middles)
+            + VectorBytes(down_offsets) + VectorBytes(down_sources) + VectorBytes(down_weights) + VectorBytes(down_middles);
+    }
+
+    void ContractionHierarchy::Build(int32_t node_count, const uint32_t* offsets, const int32_t* targets, const float* weights) {
+        Clear();
+        if (node_count <= 0) {
+            return;
+        }
+
+        Contractor contractor(node_count, offsets, targets, weights);
+        contractor.Run(*this);
+    }
+
+    bool ContractionHierarchy::IsValid(int32_t node_count) const {
+        if (ranks.size() != static_cast<size_t>(node_count)) {
+            return false;
+        }
+
+        // Ranks must be a permutation, so that every edge strictly climbs
+        std::vector<uint8_t> seen(ranks.size(), 0);
+        for (int32_t rank : ranks) {
+            if (rank < 0 || rank >= node_count || seen[rank]) {
+                return false;
+            }
+            seen[rank] = 1;
+        }
+
+        return IsValidSide(*this, up_offsets, up_targets, up_weights, up_middles)
+            && IsValidSide(*this, down_offsets, down_sources, down_weights, down_middles);
+    }
+
+    bool ContractionHierarchy::Unpack(int32_t from, int32_t to, std::vector<int32_t>& out_nodes) const {
+        // Explicit stack of edges still to expand, leftmost on top (kept per thread, queries unpack every hop)
+        thread_local std::vector<std::pair<int32_t, int32_t>> pending;
+        pending.clear();
+        pending.emplace_back(from, to);
+
+        while (!pending.empty()) {
+            const std::pair<int32_t, int32_t> edge = pending.back();
+            pending.pop_back();
+
+            int32_t middle = -2;
+            if (ranks[edge.second] > ranks[edge.first]) {
+                for (uint32_t e = up_offsets[edge.first]; e < up_offsets[edge.first + 1]; ++e) {
+                    if (up_targets[e] == edge.second) {
+                        middle = up_middles[e];
+                        break;
+                    }
+                }
+            }
+            else {
+                for (uint32_t e = down_offsets[edge.second]; e < down_offsets[edge.second + 1]; ++e) {
+                    if (down_sources[e] == edge.first) {
+                        middle = down_middles[e];
+                        break;
+                    }
+                }
+            }
+
+            if (middle == -2) {
+                return false;
+            }
+
+            if (middle < 0) {
+                out_nodes.push_back(edge.second);
+            }
+            else {
+                pending.emplace_back(middle, edge.second);
+                pending.emplace_back(edge.first, middle);
+            }
+        }
+        return true;
+    }
+
+    void ContractionHierarchy::Clear() {
+        ranks.clear();
+        up_offsets.clear();
+        up_targets.clear();
+        up_weights.clear();
+        up_middles.clear();
+        down_offsets.clear();
+        down_sources.clear();
+        down_weights.clear();
+        down_middles.clear();
+    }
+
+} // namespace Pathfinder
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pathfinder {
+
+    /**
+     * @brief Contraction hierarchy over a static directed graph
+     *
+     * Nodes are contracted one at a time, least important first; the order is their rank.
+     * Contracting a node adds a shortcut between two of its remaining neighbours whenever
+     * the path through it is the only shortest one. A shortest path is then found by two
+     * searches that only climb in rank, forward from the source over the upward edges and
+     * backward from the target over the downward edges, meeting at the top of the path.
+     *
+     * Every edge u -> w of the hierarchy is stored once: at u in the upward rows when
+     * rank(w) > rank(u), at w in the downward rows otherwise (reversed, pointing back to u).
+     */
+    struct ContractionHierarchy {
+        std::vector<int32_t> ranks;             // Contraction order of each node
+
+        std::vector<uint32_t> up_offsets;       // CSR rows of the upward edges (one per node, plus the end)
+        std::vector<int32_t> up_targets;
+        std::vector<float> up_weights;
+        std::vector<int32_t> up_middles;        // Node bypassed by a shortcut (-1 = edge of the original graph)
+
+        std::vector<uint32_t> down_offsets;     // CSR rows of the downward edges, reversed
+        std::vector<int32_t> down_sources;
+        std::vector<float> down_weights;
+        std::vector<int32_t> down_middles;
+
+        int32_t NodeCount() const {
+            return static_cast<int32_t>(ranks.size());
+        }
+
+        bool Empty() const {
+            return ranks.empty();
+        }
+
+        size_t EdgeCount() const {
+            return up_targets.size() + down_sources.size();
+        }
+
+        // Heap size in bytes
+        size_t MemoryUsage() const;
+
+        /**
+         * @brief Contracts a graph given in CSR layout (replaces any previous hierarchy)
+         * @param node_count Number of nodes
+         * @param offsets node_count + 1 row offsets
+         * @param targets Target node of each edge
+         * @param weights Non-negative weight of each edge
+         */
+        void Build(int32_t node_count, const uint32_t* offsets, const int32_t* targets, const float* weights);
+
+        /**
+         * @brief Checks that the arrays form a hierarchy the search can trust (e.g. after reading baked data)
+         * @param node_count Number of nodes of the graph the hierarchy belongs to
+         */
+        bool IsValid(int32_t node_count) const;
+
+        /**
+         * @brief Expands an edge of the hierarchy into edges of the original graph
+         * Appends the nodes of the original path after from, up to and including to.
+         * @return false if from -> to is not an edge of the hierarchy
+         */
+        bool Unpack(int32_t from, int32_t to, std::vector<int32_t>& out_nodes) const;
+
+        void Clear();
+    };
+
+} // namespace Pathfinder
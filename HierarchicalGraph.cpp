@@ -0,0 +1,217 @@
+#include "HierarchicalGraph.h"
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace Pathfinder {
+
+    namespace {
+
+        // Wanted number of nodes per cluster: more entrances per cluster (quadratic cost tables)
+        // against more clusters for the search to cross
+        const float kClusterNodes = 256.0f;
+        const float kMinCellSize = 256.0f;
+
+        // Edges of a single cluster in local node indices
+        struct ClusterGraph {
+            std::vector<uint32_t> offsets;
+            std::vector<int32_t> targets;
+            std::vector<float> weights;
+        };
+
+        // Single-source shortest paths inside a cluster (infinity for nodes not reached); out_through[v]
+        // tells whether the path found to v goes through an entrance other than the source
+        void Dijkstra(const ClusterGraph& graph, const std::vector<uint8_t>& is_entrance, int32_t source,
+                      std::vector<float>& out_distances, std::vector<int32_t>& out_previous, std::vector<uint8_t>& out_through,
+                      std::vector<std::pair<float, int32_t>>& queue) {
+            const std::greater<std::pair<float, int32_t>> queue_order;
+            out_distances.assign(graph.offsets.size() - 1, std::numeric_limits<float>::infinity());
+            out_previous.assign(graph.offsets.size() - 1, -1);
+            out_through.assign(graph.offsets.size() - 1, 0);
+            queue.clear();
+            out_distances[source] = 0.0f;
+            queue.emplace_back(0.0f, source);
+
+            while (!queue.empty()) {
+                std::pop_heap(queue.begin(), queue.end(), queue_order);
+                const std::pair<float, int32_t> current = queue.back();
+                queue.pop_back();
+                if (current.first > out_distances[current.second]) {
+                    continue; // Stale entry
+                }
+
+                const uint8_t through = out_through[current.second] || (current.second != source && is_entrance[current.second]);
+                for (uint32_t e = graph.offsets[current.second]; e < graph.offsets[current.second + 1]; ++e) {
+                    const float distance = current.first + graph.weights[e];
+                    if (distance < out_distances[graph.targets[e]]) {
+                        out_distances[graph.targets[e]] = distance;
+                        out_previous[graph.targets[e]] = current.second;
+                        out_through[graph.targets[e]] = through;
+                        queue.emplace_back(distance, graph.targets[e]);
+                        std::push_heap(queue.begin(), queue.end(), queue_order);
+                    }
+                }
+            }
+        }
+    }
+
+    size_t HierarchicalGraph::MemoryUsage() const {
+        return node_clusters.capacity() * sizeof(int32_t)
+            + entrance_indices.capacity() * sizeof(int32_t)
+            + entrance_offsets.capacity() * sizeof(uint32_t)
+            + entrances.capacity() * sizeof(int32_t)
+            + crossing_offsets.capacity() * sizeof(uint32_t)
+            + crossing_targets.capacity() * sizeof(int32_t)
+            + crossing_costs.capacity() * sizeof(float)
+            + path_offsets.capacity() * sizeof(uint32_t)
+            + path_nodes.capacity() * sizeof(int32_t);
+    }
+
+    void HierarchicalGraph::Build(int32_t node_count, const uint32_t* offsets, const int32_t* targets, const float* weights,
+                                  const float* xs, const float* ys) {
+        Clear();
+        if (node_count <= 0) {
+            return;
+        }
+
+        // Grid over the nodes, sized for kClusterNodes nodes per cell on average
+        float lo_x = xs[0], lo_y = ys[0], hi_x = xs[0], hi_y = ys[0];
+        for (int32_t node = 1; node < node_count; ++node) {
+            lo_x = std::min(lo_x, xs[node]);
+            lo_y = std::min(lo_y, ys[node]);
+            hi_x = std::max(hi_x, xs[node]);
+            hi_y = std::max(hi_y, ys[node]);
+        }
+
+        const float area = std::max(hi_x - lo_x, 1.0f) * std::max(hi_y - lo_y, 1.0f);
+        origin_x = lo_x;
+        origin_y = lo_y;
+        cell_size = std::max(std::sqrt(area * kClusterNodes / static_cast<float>(node_count)), kMinCellSize);
+        columns = std::max(1, static_cast<int32_t>(std::ceil((hi_x - lo_x) / cell_size)));
+        rows = std::max(1, static_cast<int32_t>(std::ceil((hi_y - lo_y) / cell_size)));
+        const int32_t cluster_count = ClusterCount();
+
+        node_clusters.resize(node_count);
+        for (int32_t node = 0; node < node_count; ++node) {
+            node_clusters[node] = Row(ys[node]) * columns + Column(xs[node]);
+        }
+
+        // Entrances: both ends of every edge between two clusters
+        std::vector<uint8_t> is_entrance(node_count, 0);
+        for (int32_t from = 0; from < node_count; ++from) {
+            for (uint32_t e = offsets[from]; e < offsets[from + 1]; ++e) {
+                if (node_clusters[targets[e]] != node_clusters[from]) {
+                    is_entrance[from] = 1;
+                    is_entrance[targets[e]] = 1;
+                }
+            }
+        }
+
+        // Nodes of each cluster (increasing), entrances first listed the same way
+        std::vector<uint32_t> node_offsets(cluster_count + 1, 0);
+        entrance_offsets.assign(cluster_count + 1, 0);
+        for (int32_t node = 0; node < node_count; ++node) {
+            ++node_offsets[node_clusters[node] + 1];
+            entrance_offsets[node_clusters[node] + 1] += is_entrance[node];
+        }
+        for (int32_t c = 0; c < cluster_count; ++c) {
+            node_offsets[c + 1] += node_offsets[c];
+            entrance_offsets[c + 1] += entrance_offsets[c];
+        }
+
+        std::vector<int32_t> cluster_nodes(node_count);
+        std::vector<int32_t> local_index(node_count);
+        entrances.resize(entrance_offsets[cluster_count]);
+        entrance_indices.assign(node_count, -1);
+        {
+            std::vector<uint32_t> node_cursor(node_offsets.begin(), node_offsets.end() - 1);
+            std::vector<uint32_t> entrance_cursor(entrance_offsets.begin(), entrance_offsets.end() - 1);
+            for (int32_t node = 0; node < node_count; ++node) {
+                const int32_t c = node_clusters[node];
+                local_index[node] = static_cast<int32_t>(node_cursor[c] - node_offsets[c]);
+                cluster_nodes[node_cursor[c]++] = node;
+                if (is_entrance[node]) {
+                    entrance_indices[node] = static_cast<int32_t>(entrance_cursor[c]);
+                    entrances[entrance_cursor[c]++] = node;
+                }
+            }
+        }
+
+        // One Dijkstra per entrance over the edges that stay inside its cluster
+        ClusterGraph local;
+        std::vector<uint8_t> local_entrance;
+        std::vector<float> distances;
+        std::vector<int32_t> previous;
+        std::vector<uint8_t> through;
+        std::vector<std::pair<float, int32_t>> queue;
+        crossing_offsets.assign(1, 0);
+        path_offsets.assign(1, 0);
+        for (int32_t c = 0; c < cluster_count; ++c) {
+            if (entrance_offsets[c + 1] == entrance_offsets[c]) {
+                continue;
+            }
+
+            local.offsets.assign(1, 0);
+            local.targets.clear();
+            local.weights.clear();
+            local_entrance.clear();
+            for (uint32_t i = node_offsets[c]; i < node_offsets[c + 1]; ++i) {
+                const int32_t node = cluster_nodes[i];
+                for (uint32_t e = offsets[node]; e < offsets[node + 1]; ++e) {
+                    if (node_clusters[targets[e]] == c) {
+                        local.targets.push_back(local_index[targets[e]]);
+                        local.weights.push_back(weights[e]);
+                    }
+                }
+                local.offsets.push_back(static_cast<uint32_t>(local.targets.size()));
+                local_entrance.push_back(is_entrance[node]);
+            }
+
+            for (uint32_t i = entrance_offsets[c]; i < entrance_offsets[c + 1]; ++i) {
+                const int32_t source = local_index[entrances[i]];
+                Dijkstra(local, local_entrance, source, distances, previous, through, queue);
+                for (uint32_t j = entrance_offsets[c]; j < entrance_offsets[c + 1]; ++j) {
+                    const int32_t target = local_index[entrances[j]];
+                    if (j == i || distances[target] == std::numeric_limits<float>::infinity() || through[target]) {
+                        continue;
+                    }
+
+                    crossing_targets.push_back(entrances[j]);
+                    crossing_costs.push_back(distances[target]);
+
+                    const size_t first = path_nodes.size();
+                    for (int32_t node = previous[target]; node != source; node = previous[node]) {
+                        path_nodes.push_back(cluster_nodes[node_offsets[c] + node]);
+                    }
+                    std::reverse(path_nodes.begin() + first, path_nodes.end());
+                    path_offsets.push_back(static_cast<uint32_t>(path_nodes.size()));
+                }
+                crossing_offsets.push_back(static_cast<uint32_t>(crossing_targets.size()));
+            }
+        }
+
+        crossing_offsets.shrink_to_fit();
+        crossing_targets.shrink_to_fit();
+        crossing_costs.shrink_to_fit();
+        path_offsets.shrink_to_fit();
+        path_nodes.shrink_to_fit();
+    }
+
+    void HierarchicalGraph::Clear() {
+        origin_x = 0.0f;
+        origin_y = 0.0f;
+        cell_size = 0.0f;
+        columns = 0;
+        rows = 0;
+        node_clusters.clear();
+        entrance_indices.clear();
+        entrance_offsets.clear();
+        entrances.clear();
+        crossing_offsets.clear();
+        crossing_targets.clear();
+        crossing_costs.clear();
+        path_offsets.clear();
+        path_nodes.clear();
+    }
+
+} // namespace Pathfinder
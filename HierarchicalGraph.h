@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pathfinder {
+
+    /**
+     * @brief Cluster abstraction of a graph for hierarchical search (HPA*)
+     *
+     * Nodes are partitioned into clusters by a uniform grid over their positions. A node with an
+     * edge to or from another cluster is an entrance of its cluster, and each cluster stores the
+     * shortest paths between its entrances that only use its own nodes (crossings). A search goes
+     * across a cluster from entrance to entrance in one step, and only the clusters it has to see
+     * in detail (around the start and goal, or touched by obstacles) are searched node by node.
+     *
+     * A crossing that goes through another entrance of the cluster is dropped: it is the sum of
+     * two shorter crossings, which keeps distances exact with far fewer crossings. The nodes of
+     * each crossing are stored, so a path found at cluster level needs no search to be expanded.
+     *
+     * Both ends of an edge inside a cluster lie in its cell, hence the whole edge does (cells are
+     * convex): the crossings of a cluster stay valid for any obstacle that does not touch its cell.
+     */
+    struct HierarchicalGraph {
+        float origin_x;                         // Lower corner of the cluster grid
+        float origin_y;
+        float cell_size;
+        int32_t columns;
+        int32_t rows;
+
+        std::vector<int32_t> node_clusters;     // Cluster of each node
+        std::vector<int32_t> entrance_indices;  // Index of each node in entrances (-1 if not an entrance)
+
+        std::vector<uint32_t> entrance_offsets; // CSR rows of the entrances of each cluster (plus the end)
+        std::vector<int32_t> entrances;         // Entrance nodes, increasing within a cluster
+
+        std::vector<uint32_t> crossing_offsets; // CSR rows of the crossings leaving each entrance (plus the end)
+        std::vector<int32_t> crossing_targets;  // Entrance reached
+        std::vector<float> crossing_costs;
+        std::vector<uint32_t> path_offsets;     // Nodes between the two entrances of each crossing (plus the end)
+        std::vector<int32_t> path_nodes;
+
+        HierarchicalGraph() : origin_x(0.0f), origin_y(0.0f), cell_size(0.0f), columns(0), rows(0) {}
+
+        bool Empty() const {
+            return node_clusters.empty();
+        }
+
+        int32_t NodeCount() const {
+            return static_cast<int32_t>(node_clusters.size());
+        }
+
+        int32_t ClusterCount() const {
+            return columns * rows;
+        }
+
+        // Grid column / row of a position (clamped to the grid)
+        int32_t Column(float x) const {
+            return std::min(std::max(static_cast<int32_t>(std::floor((x - origin_x) / cell_size)), 0), columns - 1);
+        }
+
+        int32_t Row(float y) const {
+            return std::min(std::max(static_cast<int32_t>(std::floor((y - origin_y) / cell_size)), 0), rows - 1);
+        }
+
+        // Heap size in bytes
+        size_t MemoryUsage() const;
+
+        /**
+         * @brief Partitions a graph given in CSR layout and computes the crossings (replaces any previous one)
+         * @param node_count Number of nodes
+         * @param offsets node_count + 1 row offsets
+         * @param targets Target node of each edge
+         * @param weights Non-negative weight of each edge
+         * @param xs X coordinate of each node
+         * @param ys Y coordinate of each node
+         */
+        void Build(int32_t node_count, const uint32_t* offsets, const int32_t* targets, const float* weights,
+                   const float* xs, const float* ys);
+
+        /**
+         * @brief Calls fn(cluster) for every cluster whose cell touches a disc
+         * Cells are widened by a unit so that rounding in Column / Row never hides a node of the disc.
+         */
+        template <typename Fn>
+        void ForEachClusterTouching(float x, float y, float radius, Fn&& fn) const {
+            const float reach = radius + 1.0f;
+            for (int32_t row = Row(y - reach); row <= Row(y + reach); ++row) {
+                for (int32_t column = Column(x - reach); column <= Column(x + reach); ++column) {
+                    const float cell_x = origin_x + column * cell_size;
+                    const float cell_y = origin_y + row * cell_size;
+                    const float dx = x - std::min(std::max(x, cell_x), cell_x + cell_size);
+                    const float dy = y - std::min(std::max(y, cell_y), cell_y + cell_size);
+                    if (dx * dx + dy * dy <= reach * reach) {
+                        fn(row * columns + column);
+                    }
+                }
+            }
+        }
+
+        void Clear();
+    };
+
+} // namespace Pathfinder
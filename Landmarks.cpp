@@ -0,0 +1,225 @@
+#include "Landmarks.h"
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace Pathfinder {
+
+    namespace {
+
+        // Exact single-source distances over a CSR graph (infinity for unreachable nodes)
+        void Dijkstra(int32_t node_count, const uint32_t* offsets, const int32_t* targets, const float* weights,
+                      int32_t source, std::vector<float>& out_distances) {
+            using QueueEntry = std::pair<float, int32_t>;   // (distance, node)
+            const std::greater<QueueEntry> queue_order;
+
+            out_distances.assign(node_count, std::numeric_limits<float>::infinity());
+            std::vector<QueueEntry> queue;
+            out_distances[source] = 0.0f;
+            queue.emplace_back(0.0f, source);
+
+            while (!queue.empty()) {
+                std::pop_heap(queue.begin(), queue.end(), queue_order);
+                const QueueEntry current = queue.back();
+                queue.pop_back();
+                if (current.first > out_distances[current.second]) {
+                    continue; // Stale entry
+                }
+
+                for (uint32_t e = offsets[current.second]; e < offsets[current.second + 1]; ++e) {
+                    const float distance = current.first + weights[e];
+                    if (distance < out_distances[targets[e]]) {
+                        out_distances[targets[e]] = distance;
+                        queue.emplace_back(distance, targets[e]);
+                        std::push_heap(queue.begin(), queue.end(), queue_order);
+                    }
+                }
+            }
+        }
+
+        // Graph with every edge reversed, CSR rows indexed by the edge target
+        struct ReversedGraph {
+            std::vector<uint32_t> offsets;
+            std::vector<int32_t> sources;
+            std::vector<float> weights;
+
+            ReversedGraph(int32_t node_count, const uint32_t* forward_offsets, const int32_t* targets, const float* forward_weights)
+                : offsets(node_count + 1, 0)
+                , sources(forward_offsets[node_count])
+                , weights(forward_offsets[node_count]) {
+                for (uint32_t e = 0; e < forward_offsets[node_count]; ++e) {
+                    ++offsets[targets[e] + 1];
+                }
+                for (int32_t node = 0; node < node_count; ++node) {
+                    offsets[node + 1] += offsets[node];
+                }
+
+                std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+                for (int32_t from = 0; from < node_count; ++from) {
+                    for (uint32_t e = forward_offsets[from]; e < forward_offsets[from + 1]; ++e) {
+                        const uint32_t slot = cursor[targets[e]]++;
+                        sources[slot] = from;
+                        weights[slot] = forward_weights[e];
+                    }
+                }
+            }
+        };
+
+        // True when every edge u -> v has a twin v -> u of the same weight
+        bool IsSymmetricGraph(int32_t node_count, const uint32_t* offsets, const int32_t* targets, const float* weights,
+                              const ReversedGraph& reversed) {
+            std::vector<std::pair<int32_t, float>> forward_row;
+            std::vector<std::pair<int32_t, float>> reversed_row;
+            for (int32_t node = 0; node < node_count; ++node) {
+                if (offsets[node + 1] - offsets[node] != reversed.offsets[node + 1] - reversed.offsets[node]) {
+                    return false;
+                }
+
+                forward_row.clear();
+                reversed_row.clear();
+                for (uint32_t e = offsets[node]; e < offsets[node + 1]; ++e) {
+                    forward_row.emplace_back(targets[e], weights[e]);
+                }
+                for (uint32_t e = reversed.offsets[node]; e < reversed.offsets[node + 1]; ++e) {
+                    reversed_row.emplace_back(reversed.sources[e], reversed.weights[e]);
+                }
+                std::sort(forward_row.begin(), forward_row.end());
+                std::sort(reversed_row.begin(), reversed_row.end());
+                if (forward_row != reversed_row) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool IsValidDistance(float distance) {
+            return distance >= 0.0f; // Also rejects NaN, infinity is allowed
+        }
+    }
+
+    size_t LandmarkTable::MemoryUsage() const {
+        return landmarks.capacity() * sizeof(int32_t)
+            + from_distances.capacity() * sizeof(float)
+            + to_distances.capacity() * sizeof(float);
+    }
+
+    void LandmarkTable::Build(int32_t node_count, const uint32_t* offsets, const int32_t* targets, const float* weights,
+                              int32_t landmark_count) {
+        Clear();
+        landmark_count = std::min(std::min(landmark_count, kMaxLandmarks), node_count);
+        if (landmark_count <= 0) {
+            return;
+        }
+
+        const ReversedGraph reversed(node_count, offsets, targets, weights);
+        const bool symmetric = IsSymmetricGraph(node_count, offsets, targets, weights, reversed);
+
+        // Isolated points are never chosen: a landmark only helps the nodes it is connected to
+        std::vector<uint8_t> connected(node_count, 0);
+        for (int32_t node = 0; node < node_count; ++node) {
+            connected[node] = offsets[node + 1] > offsets[node] || reversed.offsets[node + 1] > reversed.offsets[node];
+        }
+
+        // Farthest-point selection: each landmark is the node farthest from the ones already chosen,
+        // nodes no landmark reaches yet (another component) first
+        std::vector<float> nearest_landmark(node_count, std::numeric_limits<float>::infinity());
+        auto farthest_node = [&](const std::vector<float>& distances) {
+            int32_t best = -1;
+            for (int32_t node = 0; node < node_count; ++node) {
+                if (connected[node] && (best < 0 || distances[node] > distances[best])) {
+                    best = node;
+                }
+            }
+            return best;
+        };
+
+        std::vector<std::vector<float>> from_columns;
+        std::vector<std::vector<float>> to_columns;
+        std::vector<float> scratch;
+
+        // The first landmark is the node farthest from an arbitrary one, i.e. near the edge of the map
+        int32_t next = farthest_node(nearest_landmark);
+        if (next >= 0) {
+            Dijkstra(node_count, offsets, targets, weights, next, scratch);
+            for (float& distance : scratch) {
+                if (distance == std::numeric_limits<float>::infinity()) {
+                    distance = -1.0f; // Stay in the seed's component
+                }
+            }
+            next = farthest_node(scratch);
+        }
+
+        while (next >= 0 && static_cast<int32_t>(landmarks.size()) < landmark_count) {
+            landmarks.push_back(next);
+
+            from_columns.emplace_back();
+            Dijkstra(node_count, offsets, targets, weights, next, from_columns.back());
+            if (!symmetric) {
+                to_columns.emplace_back();
+                Dijkstra(node_count, reversed.offsets.data(), reversed.sources.data(), reversed.weights.data(), next, to_columns.back());
+            }
+
+            for (int32_t node = 0; node < node_count; ++node) {
+                float distance = from_columns.back()[node];
+                if (!symmetric) {
+                    distance = std::min(distance, to_columns.back()[node]);
+                }
+                nearest_landmark[node] = std::min(nearest_landmark[node], distance);
+            }
+
+            next = farthest_node(nearest_landmark);
+            if (next >= 0 && nearest_landmark[next] <= 0.0f) {
+                next = -1; // Every connected node is a landmark
+            }
+        }
+
+        // Interleave the columns into node-major rows
+        count = static_cast<int32_t>(landmarks.size());
+        from_distances.resize(static_cast<size_t>(node_count) * count);
+        if (!symmetric) {
+            to_distances.resize(from_distances.size());
+        }
+        for (int32_t node = 0; node < node_count; ++node) {
+            for (int32_t l = 0; l < count; ++l) {
+                from_distances[static_cast<size_t>(node) * count + l] = from_columns[l][node];
+                if (!symmetric) {
+                    to_distances[static_cast<size_t>(node) * count + l] = to_columns[l][node];
+                }
+            }
+        }
+    }
+
+    bool LandmarkTable::IsValid(int32_t node_count) const {
+        if (count <= 0 || count > kMaxLandmarks || landmarks.size() != static_cast<size_t>(count)) {
+            return false;
+        }
+
+        const size_t table_size = static_cast<size_t>(node_count) * count;
+        if (from_distances.size() != table_size || (!to_distances.empty() && to_distances.size() != table_size)) {
+            return false;
+        }
+
+        for (int32_t landmark : landmarks) {
+            if (landmark < 0 || landmark >= node_count) {
+                return false;
+            }
+        }
+
+        return std::all_of(from_distances.begin(), from_distances.end(), IsValidDistance)
+            && std::all_of(to_distances.begin(), to_distances.end(), IsValidDistance);
+    }
+
+    void LandmarkTable::BeginTarget(LandmarkTarget& target) const {
+        target.count = count;
+        std::fill(target.from_landmark, target.from_landmark + kMaxLandmarks, std::numeric_limits<float>::infinity());
+        std::fill(target.to_landmark, target.to_landmark + kMaxLandmarks, -std::numeric_limits<float>::infinity());
+    }
+
+    void LandmarkTable::Clear() {
+        count = 0;
+        landmarks.clear();
+        from_distances.clear();
+        to_distances.clear();
+    }
+
+} // namespace Pathfinder
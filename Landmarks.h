@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Pathfinder {
+
+    // Most landmarks a table holds (and the size of a LandmarkTarget)
+    constexpr int32_t kMaxLandmarks = 16;
+
+    /**
+     * @brief Landmark bounds of the node a search is heading to
+     *
+     * The goal of a query is usually a temporary point that only reaches the graph through a few
+     * entry edges (entry node -> goal). Its bounds are derived from the entries so that the
+     * triangle inequality still holds for every node whose path to the goal ends by one of them.
+     */
+    struct LandmarkTarget {
+        int32_t count;
+        float from_landmark[kMaxLandmarks];     // Lower bound of d(landmark -> goal)
+        float to_landmark[kMaxLandmarks];       // Largest d(entry -> landmark) - entry weight
+
+        LandmarkTarget() : count(0) {}
+    };
+
+    /**
+     * @brief ALT (A*, Landmarks, Triangle inequality) distance tables
+     *
+     * A handful of landmarks is chosen far apart (each one the node farthest from the ones already
+     * chosen) and the exact graph distance between every node and every landmark is stored.
+     * For any nodes v and t and landmark L, d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L);
+     * the largest of these bounds is the A* heuristic.
+     *
+     * The bounds only rely on the triangle inequality, so they stay admissible when a search skips
+     * nodes (obstacles) since that can only make the remaining paths longer.
+     *
+     * Tables are node-major (the distances of node v are [v * count, (v + 1) * count)) so a
+     * heuristic evaluation reads a single cache line. On symmetric graphs d(v, L) = d(L, v) and
+     * to_distances is left empty.
+     */
+    struct LandmarkTable {
+        int32_t count;                          // Number of landmarks
+        std::vector<int32_t> landmarks;         // Node of each landmark
+        std::vector<float> from_distances;      // d(landmark -> node), infinity if unreachable
+        std::vector<float> to_distances;        // d(node -> landmark), empty on symmetric graphs
+
+        LandmarkTable() : count(0) {}
+
+        bool Empty() const {
+            return count == 0;
+        }
+
+        int32_t NodeCount() const {
+            return count > 0 ? static_cast<int32_t>(from_distances.size() / count) : 0;
+        }
+
+        bool IsSymmetric() const {
+            return to_distances.empty();
+        }
+
+        // Heap size in bytes
+        size_t MemoryUsage() const;
+
+        /**
+         * @brief Chooses the landmarks and computes their distance tables (replaces any previous table)
+         * @param node_count Number of nodes
+         * @param offsets node_count + 1 row offsets
+         * @param targets Target node of each edge
+         * @param weights Non-negative weight of each edge
+         * @param landmark_count Wanted number of landmarks (capped by kMaxLandmarks and the node count)
+         */
+        void Build(int32_t node_count, const uint32_t* offsets, const int32_t* targets, const float* weights,
+                   int32_t landmark_count = kMaxLandmarks);
+
+        /**
+         * @brief Checks that the arrays are consistent (e.g. after reading baked data)
+         * @param node_count Number of nodes of the graph the table belongs to
+         */
+        bool IsValid(int32_t node_count) const;
+
+        /**
+         * @brief Starts the bounds of a target reached through entry edges
+         * Call AddTargetEntry for each entry edge afterwards.
+         */
+        void BeginTarget(LandmarkTarget& target) const;
+
+        /**
+         * @brief Adds an entry edge node -> target of the given weight (weight 0 when node is the target itself)
+         */
+        void AddTargetEntry(LandmarkTarget& target, int32_t node, float weight) const {
+            const float* from = &from_distances[static_cast<size_t>(node) * count];
+            const float* to = IsSymmetric() ? from : &to_distances[static_cast<size_t>(node) * count];
+            for (int32_t l = 0; l < count; ++l) {
+                // d(L, target) >= min over entries of d(L, entry) + weight
+                target.from_landmark[l] = std::min(target.from_landmark[l], from[l] + weight);
+                // d(v, target) >= d(v, entry) + weight >= d(v, L) - (d(entry, L) - weight) for the entry v uses
+                target.to_landmark[l] = std::max(target.to_landmark[l], to[l] - weight);
+            }
+        }
+
+        /**
+         * @brief Lower bound of the distance from a node to a target
+         * Infinity when the tables prove that the node cannot reach the target.
+         */
+        float LowerBound(int32_t node, const LandmarkTarget& target) const {
+            const float infinity = std::numeric_limits<float>::infinity();
+            const float* from = &from_distances[static_cast<size_t>(node) * count];
+            const float* to = IsSymmetric() ? from : &to_distances[static_cast<size_t>(node) * count];
+            float bound = 0.0f;
+            for (int32_t l = 0; l < target.count; ++l) {
+                // Both terms are skipped when they would be infinity - infinity
+                if (from[l] < infinity) {
+                    bound = std::max(bound, target.from_landmark[l] - from[l]);
+                }
+                if (target.to_landmark[l] < infinity) {
+                    bound = std::max(bound, to[l] - target.to_landmark[l]);
+                }
+            }
+            return bound;
+        }
+
+        void Clear();
+    };
+
+} // namespace Pathfinder
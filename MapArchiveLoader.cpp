@@ -3,73 +3,23 @@
 #include <algorithm>
 #include <sstream>
 #include <cstring>
+#include <thread>
 
 namespace Pathfinder {
 
-    // ==================== MapCache Implementation ====================
-
-    MapCache::MapCache(size_t max_size)
-        : m_max_size(max_size) {
-    }
-
-    std::string MapCache::Get(int32_t map_id) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        auto it = m_cache.find(map_id);
-        if (it == m_cache.end()) {
-            return "";
-        }
-
-        // Move this element to the front of the LRU list
-        m_lru_list.erase(it->second.lru_it);
-        m_lru_list.push_front(map_id);
-        it->second.lru_it = m_lru_list.begin();
-
-        return it->second.data;
-    }
-
-    void MapCache::Put(int32_t map_id, const std::string& data) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        auto it = m_cache.find(map_id);
-        if (it != m_cache.end()) {
-            // Update existing entry
-            m_lru_list.erase(it->second.lru_it);
-            m_lru_list.push_front(map_id);
-            it->second.data = data;
-            it->second.lru_it = m_lru_list.begin();
-        }
-        else {
-            // New entry
-            if (m_cache.size() >= m_max_size) {
-                // Remove the least recently used element
-                int32_t old_id = m_lru_list.back();
-                m_lru_list.pop_back();
-                m_cache.erase(old_id);
-            }
-
-            m_lru_list.push_front(map_id);
-            CacheEntry entry;
-            entry.data = data;
-            entry.lru_it = m_lru_list.begin();
-            m_cache[map_id] = entry;
-        }
-    }
-
-    void MapCache::Clear() {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_cache.clear();
-        m_lru_list.clear();
-    }
-
     // ==================== MapArchiveLoader Implementation ====================
 
     MapArchiveLoader::MapArchiveLoader()
         : m_initialized(false)
-        , m_cache(std::make_unique<MapCache>(20)) {
+        , m_max_idle_archives(std::max(2u, std::thread::hardware_concurrency())) {
     }
 
     MapArchiveLoader::~MapArchiveLoader() {
+        std::lock_guard<std::mutex> lock(m_pool_mutex);
+        for (zip_t* archive : m_idle_archives) {
+            zip_close(archive);
+        }
+        m_idle_archives.clear();
     }
 
     MapArchiveLoader& MapArchiveLoader::GetInstance() {
@@ -92,40 +42,27 @@ namespace Pathfinder {
         if (!archive) {
             return false;
         }
-        zip_close(archive);
 
-        // Scan the archive to find all available maps
-        ScanArchive();
+        // Read the central directory once, then keep the handle for the first load
+        ScanArchive(archive);
+        ReleaseArchive(archive);
 
-        m_initialized = true;
+        m_initialized.store(true, std::memory_order_release);
         return true;
     }
 
     std::string MapArchiveLoader::LoadMapData(int32_t map_id) {
-        if (!m_initialized) {
+        if (!m_initialized.load(std::memory_order_acquire)) {
             return "";
         }
 
-        // Check the cache first
-        std::string cached = m_cache->Get(map_id);
-        if (!cached.empty()) {
-            return cached;
-        }
-
-        // Find the file corresponding to map_id in the archive
         // Files are named like: "100_Prophecies_Kryta_...json"
-        std::string data = FindAndReadMapFile(map_id);
-        if (!data.empty()) {
-            // Add to cache
-            m_cache->Put(map_id, data);
-        }
-
-        return data;
+        return FindAndReadMapFile(map_id);
     }
 
     bool MapArchiveLoader::HasMap(int32_t map_id) const {
         std::lock_guard<std::mutex> lock(m_mutex);
-        return std::find(m_available_maps.begin(), m_available_maps.end(), map_id) != m_available_maps.end();
+        return m_map_entries.find(map_id) != m_map_entries.end();
     }
 
     std::vector<int32_t> MapArchiveLoader::GetAvailableMapIds() const {
@@ -133,92 +70,63 @@ namespace Pathfinder {
         return m_available_maps;
     }
 
-    void MapArchiveLoader::ClearCache() {
-        m_cache->Clear();
-    }
-
-    std::string MapArchiveLoader::ReadFileFromZip(const std::string& filename) {
-        std::lock_guard<std::mutex> lock(m_mutex);
-
-        int error_code = 0;
-        zip_t* archive = zip_open(m_archive_path.c_str(), ZIP_RDONLY, &error_code);
-        if (!archive) {
-            return "";
-        }
-
-        // Find the file in the archive
-        zip_stat_t stat;
-        if (zip_stat(archive, filename.c_str(), 0, &stat) != 0) {
-            zip_close(archive);
-            return "";
-        }
-
-        // Open the file
-        zip_file_t* file = zip_fopen(archive, filename.c_str(), 0);
-        if (!file) {
-            zip_close(archive);
-            return "";
+    zip_t* MapArchiveLoader::AcquireArchive() {
+        {
+            std::lock_guard<std::mutex> lock(m_pool_mutex);
+            if (!m_idle_archives.empty()) {
+                zip_t* archive = m_idle_archives.back();
+                m_idle_archives.pop_back();
+                return archive;
+            }
         }
 
-        // Read the content
-        std::string content;
-        content.resize(stat.size);
+        // No idle handle: open another one outside the lock
+        int error_code = 0;
+        return zip_open(m_archive_path.c_str(), ZIP_RDONLY, &error_code);
+    }
 
-        zip_int64_t bytes_read = zip_fread(file, &content[0], stat.size);
-        if (bytes_read < 0) {
-            zip_fclose(file);
-            zip_close(archive);
-            return "";
+    void MapArchiveLoader::ReleaseArchive(zip_t* archive) {
+        {
+            std::lock_guard<std::mutex> lock(m_pool_mutex);
+            if (m_idle_archives.size() < m_max_idle_archives) {
+                m_idle_archives.push_back(archive);
+                return;
+            }
         }
 
-        content.resize(bytes_read);
-
-        zip_fclose(file);
         zip_close(archive);
-
-        return content;
     }
 
     std::string MapArchiveLoader::FindAndReadMapFile(int32_t map_id) {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t index = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_map_entries.find(map_id);
+            if (it == m_map_entries.end()) {
+                return "";
+            }
+            index = it->second;
+        }
 
-        int error_code = 0;
-        zip_t* archive = zip_open(m_archive_path.c_str(), ZIP_RDONLY, &error_code);
+        // Decompression runs on a handle owned by this thread, without any lock held
+        zip_t* archive = AcquireArchive();
         if (!archive) {
             return "";
         }
 
-        // Search for a file that starts with "map_id_"
-        std::string prefix = std::to_string(map_id) + "_";
-        zip_int64_t num_entries = zip_get_num_entries(archive, 0);
-
-        for (zip_int64_t i = 0; i < num_entries; ++i) {
-            const char* name = zip_get_name(archive, i, 0);
-            if (!name) continue;
-
-            std::string filename(name);
-            // Check if the file starts with map_id and ends with .json
-            if (filename.find(prefix) == 0 && filename.find(".json") != std::string::npos) {
-                // File found, read it
-                std::string content = ReadFileFromZipUnlocked(archive, filename);
-                zip_close(archive);
-                return content;
-            }
-        }
-
-        zip_close(archive);
-        return "";
+        std::string content = ReadEntry(archive, index);
+        ReleaseArchive(archive);
+        return content;
     }
 
-    std::string MapArchiveLoader::ReadFileFromZipUnlocked(zip_t* archive, const std::string& filename) {
-        // Find the file in the archive
+    std::string MapArchiveLoader::ReadEntry(zip_t* archive, uint64_t index) {
         zip_stat_t stat;
-        if (zip_stat(archive, filename.c_str(), 0, &stat) != 0) {
+        if (zip_stat_index(archive, index, 0, &stat) != 0) {
             return "";
         }
 
         // Open the file
-        zip_file_t* file = zip_fopen(archive, filename.c_str(), 0);
+        zip_file_t* file = zip_fopen_index(archive, index, 0);
         if (!file) {
             return "";
         }
@@ -239,14 +147,9 @@ namespace Pathfinder {
         return content;
     }
 
-    void MapArchiveLoader::ScanArchive() {
+    void MapArchiveLoader::ScanArchive(zip_t* archive) {
         m_available_maps.clear();
-
-        int error_code = 0;
-        zip_t* archive = zip_open(m_archive_path.c_str(), ZIP_RDONLY, &error_code);
-        if (!archive) {
-            return;
-        }
+        m_map_entries.clear();
 
         zip_int64_t num_entries = zip_get_num_entries(archive, 0);
         for (zip_int64_t i = 0; i < num_entries; ++i) {
@@ -263,7 +166,11 @@ namespace Pathfinder {
                     std::string id_str = filename.substr(0, first_underscore);
                     try {
                         int32_t map_id = std::stoi(id_str);
-                        m_available_maps.push_back(map_id);
+
+                        // The first entry of a map wins, as with the previous name search
+                        if (m_map_entries.emplace(map_id, static_cast<uint64_t>(i)).second) {
+                            m_available_maps.push_back(map_id);
+                        }
                     }
                     catch (...) {
                         // Ignore files with invalid names
@@ -272,8 +179,6 @@ namespace Pathfinder {
             }
         }
 
-        zip_close(archive);
-
         // Sort IDs for easier searching
         std::sort(m_available_maps.begin(), m_available_maps.end());
     }
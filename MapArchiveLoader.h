@@ -1,10 +1,10 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <unordered_map>
-#include <memory>
 #include <mutex>
-#include <list>
+#include <atomic>
 #include <cstdint>
 
 // Forward declare zip_t to avoid including zip.h in header
@@ -12,48 +12,15 @@ typedef struct zip zip_t;
 
 namespace Pathfinder {
 
-    /**
-     * @brief LRU cache manager for map data
-     *
-     * Caches JSON data from recently used maps to avoid
-     * re-reading the ZIP archive each time.
-     */
-    class MapCache {
-    public:
-        explicit MapCache(size_t max_size = 20);
-
-        // Gets map data from cache (returns "" if not found)
-        std::string Get(int32_t map_id);
-
-        // Adds or updates an entry in the cache
-        void Put(int32_t map_id, const std::string& data);
-
-        // Clears the entire cache
-        void Clear();
-
-        // Returns the current cache size
-        size_t Size() const { return m_cache.size(); }
-
-    private:
-        size_t m_max_size;
-        std::mutex m_mutex;
-
-        // List to maintain LRU order (most recent = front)
-        std::list<int32_t> m_lru_list;
-
-        // Map: map_id -> (data, iterator in lru_list)
-        struct CacheEntry {
-            std::string data;
-            std::list<int32_t>::iterator lru_it;
-        };
-        std::unordered_map<int32_t, CacheEntry> m_cache;
-    };
-
     /**
      * @brief Map data loader from ZIP archive
      *
      * This class handles lazy loading of JSON data from a ZIP archive.
-     * Data is loaded on demand and cached to improve performance.
+     * Data is read on demand; parsed maps are cached by the engine (see MapCache.h).
+     *
+     * The central directory is read once at initialization into a map_id -> entry index
+     * table. Archive handles are kept open in a small pool: each load borrows its own
+     * handle, so loads of different maps decompress in parallel.
      */
     class MapArchiveLoader {
     public:
@@ -95,32 +62,36 @@ namespace Pathfinder {
          */
         bool IsInitialized() const { return m_initialized; }
 
-        /**
-         * @brief Clears the map cache
-         */
-        void ClearCache();
-
         // Disallow copying
         MapArchiveLoader(const MapArchiveLoader&) = delete;
         MapArchiveLoader& operator=(const MapArchiveLoader&) = delete;
 
     private:
-        bool m_initialized;
+        std::atomic<bool> m_initialized;   // Set once the archive index is built
         std::string m_archive_path;
         mutable std::mutex m_mutex;
 
-        // LRU cache for map data
-        std::unique_ptr<MapCache> m_cache;
-
-        // List of available map IDs in the archive
+        // Sorted list of available map IDs in the archive
         std::vector<int32_t> m_available_maps;
 
+        // map_id -> index of its entry in the archive (filled once by ScanArchive)
+        std::unordered_map<int32_t, uint64_t> m_map_entries;
+
+        // Open read-only handles waiting to be reused
+        std::mutex m_pool_mutex;
+        std::vector<zip_t*> m_idle_archives;
+        size_t m_max_idle_archives;
+
         /**
-         * @brief Reads a file from the ZIP archive
-         * @param filename Name of the file in the archive (e.g., "map_123.json")
-         * @return File content, or "" on error
+         * @brief Takes an open archive handle from the pool, opening a new one if none is idle
+         * @return Archive handle, or nullptr if the archive cannot be opened
+         */
+        zip_t* AcquireArchive();
+
+        /**
+         * @brief Returns a handle to the pool (closed if the pool is full)
          */
-        std::string ReadFileFromZip(const std::string& filename);
+        void ReleaseArchive(zip_t* archive);
 
         /**
          * @brief Finds and reads a map file by its ID
@@ -130,17 +101,18 @@ namespace Pathfinder {
         std::string FindAndReadMapFile(int32_t map_id);
 
         /**
-         * @brief Reads a file from an already opened archive (without lock)
-         * @param archive Already opened ZIP archive
-         * @param filename Name of the file to read
+         * @brief Reads an entry of an archive by index
+         * @param archive Open archive, used by the calling thread only
+         * @param index Index of the entry in the archive
          * @return File content, or "" on error
          */
-        std::string ReadFileFromZipUnlocked(zip_t* archive, const std::string& filename);
+        std::string ReadEntry(zip_t* archive, uint64_t index);
 
         /**
          * @brief Scans the archive to find all available maps
+         * @param archive Open archive
          */
-        void ScanArchive();
+        void ScanArchive(zip_t* archive);
     };
 
 } // namespace Pathfinder
@@ -0,0 +1,184 @@
+// GWMapBaker - bakes the JSON maps into the binary pack loaded by the DLL (maps.nav)
+//
+// Usage: GWMapBaker [--ch] <maps_dir> <output.nav>
+//
+// Every {mapId}_*.json file of maps_dir is parsed with the engine's loader and
+// written in the binary navigation format (see BinaryMapFormat.h), with its landmark tables.
+// --ch also bakes the contraction hierarchy of each map (slow). Maps are baked in parallel.
+// A second pass adds the travel costs of each map, which need the transitions of every map
+// (see WorldGraph.h).
+
+#include "PathfinderCore.h"
+#include "BinaryMapFormat.h"
+#include "WorldGraph.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv) {
+    bool with_ch = false;
+    int arg = 1;
+    if (arg < argc && std::strcmp(argv[arg], "--ch") == 0) {
+        with_ch = true;
+        arg++;
+    }
+
+    if (argc - arg < 2) {
+        std::fprintf(stderr, "Usage: %s [--ch] <maps_dir> <output.nav>\n", argv[0]);
+        return 1;
+    }
+    const char* maps_dir = argv[arg];
+    const char* output_path = argv[arg + 1];
+
+    // Collect {mapId}_*.json files
+    std::vector<std::pair<int32_t, fs::path>> files;
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(maps_dir, error)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".json") {
+            continue;
+        }
+
+        std::string filename = entry.path().filename().string();
+        size_t first_underscore = filename.find('_');
+        if (first_underscore == std::string::npos || first_underscore == 0) {
+            continue;
+        }
+
+        try {
+            files.emplace_back(std::stoi(filename.substr(0, first_underscore)), entry.path());
+        }
+        catch (...) {
+            // Ignore files with invalid names
+        }
+    }
+
+    if (error) {
+        std::fprintf(stderr, "Cannot read directory %s\n", maps_dir);
+        return 1;
+    }
+
+    std::sort(files.begin(), files.end());
+
+    // Only the first file of each map is baked
+    std::vector<std::pair<int32_t, fs::path>> unique_files;
+    for (const auto& file : files) {
+        if (!unique_files.empty() && unique_files.back().first == file.first) {
+            std::fprintf(stderr, "Skipping %s: map %d already baked\n", file.second.string().c_str(), file.first);
+            continue;
+        }
+        unique_files.push_back(file);
+    }
+
+    // Runs fn(i) for every file, each worker taking the next one
+    auto for_each_file = [&](const std::function<void(size_t)>& fn) {
+        std::atomic<size_t> next_file(0);
+        auto work = [&]() {
+            for (size_t i = next_file++; i < unique_files.size(); i = next_file++) {
+                fn(i);
+            }
+        };
+
+        const unsigned worker_count = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> workers;
+        for (unsigned w = 1; w < worker_count; ++w) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    // Maps are independent: results keep the directory order
+    std::vector<std::vector<uint8_t>> results(unique_files.size());
+    std::vector<char> succeeded(unique_files.size(), 0);
+    std::vector<std::vector<Pathfinder::MapTransition>> transitions(unique_files.size());
+
+    for_each_file([&](size_t i) {
+        const auto& file = unique_files[i];
+
+        std::ifstream input(file.second, std::ios::in | std::ios::binary);
+        std::stringstream buffer;
+        buffer << input.rdbuf();
+
+        Pathfinder::MapData map_data;
+        if (!Pathfinder::PathfinderEngine::BuildMapFromJson(file.first, buffer.str(), map_data)) {
+            std::fprintf(stderr, "Failed to load %s\n", file.second.string().c_str());
+            return;
+        }
+        if (map_data.stats.unconnected_teleport_count > 0) {
+            std::fprintf(stderr, "%s: %d teleporter(s) with an end that is not a graph point, left out\n",
+                         file.second.string().c_str(), map_data.stats.unconnected_teleport_count);
+        }
+
+        map_data.BuildLandmarks();
+        if (with_ch) {
+            map_data.BuildContractionHierarchy();
+        }
+
+        Pathfinder::WriteBinaryMap(map_data, results[i]);
+        transitions[i] = map_data.GetTransitions();
+        succeeded[i] = 1;
+    });
+
+    // Where the transitions of every map lead, then the walks from there on each map
+    std::unordered_map<int32_t, std::vector<Pathfinder::Vec2f>> arrivals;
+    for (size_t i = 0; i < unique_files.size(); ++i) {
+        for (const auto& transition : transitions[i]) {
+            std::vector<Pathfinder::Vec2f>& positions = arrivals[transition.dest_map_id];
+            const bool known = std::any_of(positions.begin(), positions.end(), [&transition](const Pathfinder::Vec2f& pos) {
+                return pos.x == transition.dest_pos.x && pos.y == transition.dest_pos.y;
+            });
+            if (!known) {
+                positions.push_back(transition.dest_pos);
+            }
+        }
+    }
+
+    Pathfinder::PathfinderEngine engine;
+    for_each_file([&](size_t i) {
+        auto it = arrivals.find(unique_files[i].first);
+        if (!succeeded[i] || it == arrivals.end()) {
+            return;
+        }
+
+        Pathfinder::MapData map_data;
+        if (!Pathfinder::PathfinderEngine::BuildMapFromBinary(unique_files[i].first, results[i].data(), results[i].size(), map_data)) {
+            return;
+        }
+        Pathfinder::BuildTravelCosts(engine, map_data, it->second);
+        Pathfinder::WriteBinaryMap(map_data, results[i]);
+    });
+
+    std::vector<std::pair<int32_t, std::vector<uint8_t>>> baked;
+    int failures = 0;
+    for (size_t i = 0; i < unique_files.size(); ++i) {
+        if (succeeded[i]) {
+            baked.emplace_back(unique_files[i].first, std::move(results[i]));
+        }
+        else {
+            failures++;
+        }
+    }
+
+    if (!Pathfinder::WriteBinaryPack(output_path, baked)) {
+        std::fprintf(stderr, "Cannot write %s\n", output_path);
+        return 1;
+    }
+
+    // Maps that failed to bake are still served from maps.zip at runtime
+    std::printf("Baked %zu maps into %s (%d failed)%s\n", baked.size(), output_path, failures,
+                with_ch ? " with contraction hierarchies" : "");
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include "MapCache.h"
+#include "PathfinderCore.h"
+#include <algorithm>
+#include <mutex>
+
+namespace Pathfinder {
+
+    MapCache::MapCache(uint64_t byte_budget)
+        : m_byte_budget(byte_budget)
+        , m_bytes_used(0)
+        , m_clock(0)
+        , m_hits(0)
+        , m_misses(0)
+        , m_evictions(0) {
+    }
+
+    void MapCache::Touch(const CacheEntry& entry) const {
+        entry.last_used.store(m_clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<const MapData> MapCache::Get(int32_t map_id) const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        auto it = m_entries.find(map_id);
+        if (it == m_entries.end()) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        Touch(it->second);
+        return it->second.map;
+    }
+
+    std::shared_ptr<const MapData> MapCache::Find(int32_t map_id) const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        auto it = m_entries.find(map_id);
+        if (it == m_entries.end()) {
+            return nullptr;
+        }
+
+        Touch(it->second);
+        return it->second.map;
+    }
+
+    std::shared_ptr<const MapData> MapCache::Peek(int32_t map_id) const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        auto it = m_entries.find(map_id);
+        return it != m_entries.end() ? it->second.map : nullptr;
+    }
+
+    void MapCache::Put(int32_t map_id, std::shared_ptr<const MapData> map) {
+        if (!map) {
+            return;
+        }
+
+        // Sized outside the lock
+        const uint64_t bytes = map->MemoryUsage();
+
+        // The replaced map (if any) is released after the lock
+        std::shared_ptr<const MapData> previous;
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        CacheEntry& entry = m_entries[map_id];
+        m_bytes_used -= entry.bytes;
+        previous = std::move(entry.map);
+        entry.map = std::move(map);
+        entry.bytes = bytes;
+        Touch(entry);
+
+        m_bytes_used += bytes;
+        EvictUnlocked(map_id);
+    }
+
+    bool MapCache::Remove(int32_t map_id) {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        auto it = m_entries.find(map_id);
+        if (it == m_entries.end()) {
+            return false;
+        }
+
+        m_bytes_used -= it->second.bytes;
+        m_entries.erase(it);
+        return true;
+    }
+
+    bool MapCache::Contains(int32_t map_id) const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_entries.find(map_id) != m_entries.end();
+    }
+
+    std::vector<int32_t> MapCache::GetMapIds() const {
+        std::vector<std::pair<uint64_t, int32_t>> by_use;
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            by_use.reserve(m_entries.size());
+            for (const auto& pair : m_entries) {
+                by_use.emplace_back(pair.second.last_used.load(std::memory_order_relaxed), pair.first);
+            }
+        }
+
+        // Most recently used first
+        std::sort(by_use.rbegin(), by_use.rend());
+
+        std::vector<int32_t> ids;
+        ids.reserve(by_use.size());
+        for (const auto& entry : by_use) {
+            ids.push_back(entry.second);
+        }
+        return ids;
+    }
+
+    void MapCache::Pin(int32_t map_id) {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_pins[map_id]++;
+    }
+
+    bool MapCache::Unpin(int32_t map_id) {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        auto it = m_pins.find(map_id);
+        if (it == m_pins.end()) {
+            return false;
+        }
+
+        if (--it->second == 0) {
+            m_pins.erase(it);
+
+            // The map may have been kept over budget by its pin
+            EvictUnlocked(-1);
+        }
+        return true;
+    }
+
+    bool MapCache::IsPinned(int32_t map_id) const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_pins.find(map_id) != m_pins.end();
+    }
+
+    void MapCache::SetByteBudget(uint64_t byte_budget) {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_byte_budget = byte_budget;
+        EvictUnlocked(-1);
+    }
+
+    MapCacheStatistics MapCache::GetStatistics() const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        MapCacheStatistics stats;
+        stats.hits = m_hits.load(std::memory_order_relaxed);
+        stats.misses = m_misses.load(std::memory_order_relaxed);
+        stats.evictions = m_evictions;
+        stats.bytes_used = m_bytes_used;
+        stats.byte_budget = m_byte_budget;
+        stats.map_count = static_cast<int32_t>(m_entries.size());
+        stats.pinned_count = static_cast<int32_t>(m_pins.size());
+        return stats;
+    }
+
+    void MapCache::ResetCounters() {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_hits = 0;
+        m_misses = 0;
+        m_evictions = 0;
+    }
+
+    void MapCache::Clear() {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_entries.clear();
+        m_bytes_used = 0;
+    }
+
+    void MapCache::EvictUnlocked(int32_t keep_map_id) {
+        if (m_bytes_used <= m_byte_budget) {
+            return;
+        }
+
+        // Least recently used candidates first
+        std::vector<std::pair<uint64_t, int32_t>> candidates;
+        candidates.reserve(m_entries.size());
+        for (const auto& pair : m_entries) {
+            if (pair.first != keep_map_id && m_pins.find(pair.first) == m_pins.end()) {
+                candidates.emplace_back(pair.second.last_used.load(std::memory_order_relaxed), pair.first);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (const auto& candidate : candidates) {
+            if (m_bytes_used <= m_byte_budget) {
+                break;
+            }
+
+            auto entry = m_entries.find(candidate.second);
+            m_bytes_used -= entry->second.bytes;
+            m_entries.erase(entry);
+            m_evictions++;
+        }
+    }
+
+} // namespace Pathfinder
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Pathfinder {
+
+    struct MapData;
+
+    // Counters and occupancy of the map cache
+    struct MapCacheStatistics {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t bytes_used;
+        uint64_t byte_budget;
+        int32_t map_count;
+        int32_t pinned_count;
+
+        MapCacheStatistics() : hits(0), misses(0), evictions(0), bytes_used(0), byte_budget(0),
+                               map_count(0), pinned_count(0) {}
+    };
+
+    /**
+     * @brief Byte-budgeted LRU cache of parsed maps
+     *
+     * Maps are stored immutable behind shared_ptr: an evicted map stays alive for as long
+     * as a query still holds it. When the resident size goes over the budget, the least
+     * recently used maps are evicted, except pinned ones (a pinned map may push the cache
+     * over its budget). Pins are counted and may be taken before the map is cached.
+     *
+     * Lookups only take a shared lock: the LRU order is kept as a per-entry use tick updated
+     * atomically, and sorted only when maps have to be evicted. Inserting, removing and
+     * pinning take the exclusive lock, never for longer than the bookkeeping itself.
+     */
+    class MapCache {
+    public:
+        static constexpr uint64_t kDefaultByteBudget = 64ull * 1024 * 1024;
+
+        explicit MapCache(uint64_t byte_budget = kDefaultByteBudget);
+
+        /**
+         * @brief Looks a map up, counting a hit or a miss and refreshing its LRU position
+         * @return The map, or nullptr if it is not cached
+         */
+        std::shared_ptr<const MapData> Get(int32_t map_id) const;
+
+        /**
+         * @brief Looks a map up and refreshes its LRU position, without touching the counters
+         */
+        std::shared_ptr<const MapData> Find(int32_t map_id) const;
+
+        // Looks a map up without touching the LRU order nor the counters
+        std::shared_ptr<const MapData> Peek(int32_t map_id) const;
+
+        /**
+         * @brief Adds or replaces a map, then evicts down to the budget
+         * The map just inserted is never evicted by its own insertion.
+         */
+        void Put(int32_t map_id, std::shared_ptr<const MapData> map);
+
+        // Removes a map (returns false if it was not cached); pins are kept
+        bool Remove(int32_t map_id);
+
+        bool Contains(int32_t map_id) const;
+
+        std::vector<int32_t> GetMapIds() const;
+
+        // Pins a map against eviction (counted, the map does not need to be cached yet)
+        void Pin(int32_t map_id);
+
+        // Releases one pin (returns false if the map was not pinned)
+        bool Unpin(int32_t map_id);
+
+        bool IsPinned(int32_t map_id) const;
+
+        // Changes the budget, evicting immediately if needed
+        void SetByteBudget(uint64_t byte_budget);
+
+        MapCacheStatistics GetStatistics() const;
+
+        void ResetCounters();
+
+        void Clear();
+
+        // Disallow copying
+        MapCache(const MapCache&) = delete;
+        MapCache& operator=(const MapCache&) = delete;
+
+    private:
+        struct CacheEntry {
+            std::shared_ptr<const MapData> map;
+            uint64_t bytes;
+            mutable std::atomic<uint64_t> last_used;    // Use tick, higher = more recent
+
+            CacheEntry() : bytes(0), last_used(0) {}
+        };
+
+        // Stamps an entry as the most recently used one
+        void Touch(const CacheEntry& entry) const;
+
+        // Evicts the least recently used unpinned maps until the budget is met (exclusive lock held)
+        void EvictUnlocked(int32_t keep_map_id);
+
+        mutable std::shared_mutex m_mutex;
+        uint64_t m_byte_budget;
+        uint64_t m_bytes_used;
+        mutable std::atomic<uint64_t> m_clock;
+        mutable std::atomic<uint64_t> m_hits;
+        mutable std::atomic<uint64_t> m_misses;
+        uint64_t m_evictions;
+
+        // Nodes never move, so entries can be read under the shared lock while their tick changes
+        std::unordered_map<int32_t, CacheEntry> m_entries;
+
+        // map_id -> pin count
+        std::unordered_map<int32_t, int32_t> m_pins;
+    };
+
+} // namespace Pathfinder
@@ -1,5 +1,6 @@
 #include "MapDataRegistry.h"
 #include "MapArchiveLoader.h"
+#include <algorithm>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -26,24 +27,43 @@ namespace Pathfinder {
             path = GetDefaultArchivePath();
         }
 
+        // The baked pack lives next to the archive
+        if (!m_pack.IsOpen()) {
+            size_t separator = path.find_last_of("\\/");
+            std::string pack_path = (separator == std::string::npos) ? "maps.nav" : path.substr(0, separator + 1) + "maps.nav";
+            m_pack.Open(pack_path);
+        }
+
         // Initialize the archive loader
-        return MapArchiveLoader::GetInstance().Initialize(path);
+        bool archive_ok = MapArchiveLoader::GetInstance().Initialize(path);
+        return archive_ok || m_pack.IsOpen();
     }
 
     std::string MapDataRegistry::GetMapData(int32_t map_id) {
         return MapArchiveLoader::GetInstance().LoadMapData(map_id);
     }
 
+    bool MapDataRegistry::GetBakedMapData(int32_t map_id, const uint8_t*& out_data, size_t& out_size) const {
+        return m_pack.GetMap(map_id, out_data, out_size);
+    }
+
     bool MapDataRegistry::HasMap(int32_t map_id) const {
-        return MapArchiveLoader::GetInstance().HasMap(map_id);
+        return m_pack.HasMap(map_id) || MapArchiveLoader::GetInstance().HasMap(map_id);
     }
 
     std::vector<int32_t> MapDataRegistry::GetAvailableMapIds() const {
-        return MapArchiveLoader::GetInstance().GetAvailableMapIds();
+        std::vector<int32_t> ids = MapArchiveLoader::GetInstance().GetAvailableMapIds();
+        if (m_pack.IsOpen()) {
+            std::vector<int32_t> baked = m_pack.GetMapIds();
+            ids.insert(ids.end(), baked.begin(), baked.end());
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        }
+        return ids;
     }
 
     bool MapDataRegistry::IsInitialized() const {
-        return MapArchiveLoader::GetInstance().IsInitialized();
+        return MapArchiveLoader::GetInstance().IsInitialized() || m_pack.IsOpen();
     }
 
     std::string MapDataRegistry::GetDefaultArchivePath() const {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BinaryMapFormat.h"
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -10,10 +11,12 @@ namespace Pathfinder {
      * @brief Singleton registry for loading map data
      *
      * This class loads JSON map data on demand from a ZIP archive.
-     * Data is automatically cached to improve performance.
+     * Parsed maps are cached by the engine (see MapCache.h).
+     * If a baked pack (maps.nav, see BinaryMapFormat.h) sits next to the archive,
+     * it is memory-mapped and preferred over the JSON files.
      *
      * Configuration:
-     * 1. Place the maps.zip file in the same directory as the DLL
+     * 1. Place the maps.zip file (and optionally maps.nav) in the same directory as the DLL
      * 2. The file must contain files named {mapId}_*.json (e.g., 7_Prophecies_...json, 123_Factions_...json)
      */
     class MapDataRegistry {
@@ -24,7 +27,7 @@ namespace Pathfinder {
         /**
          * @brief Initializes the registry with the archive path
          * @param archive_path Path to maps.zip (optional, defaults to the DLL folder)
-         * @return true if initialization succeeded
+         * @return true if initialization succeeded (archive or baked pack found)
          */
         bool Initialize(const std::string& archive_path = "");
 
@@ -35,6 +38,15 @@ namespace Pathfinder {
          */
         std::string GetMapData(int32_t map_id);
 
+        /**
+         * @brief Returns the baked binary data of a map from maps.nav
+         * @param map_id ID of the map
+         * @param out_data Receives a pointer into the memory-mapped pack (valid until shutdown)
+         * @param out_size Receives the size in bytes
+         * @return true if the map is in the baked pack
+         */
+        bool GetBakedMapData(int32_t map_id, const uint8_t*& out_data, size_t& out_size) const;
+
         /**
          * @brief Checks if a map is available
          * @param map_id ID of the map to check
@@ -66,6 +78,9 @@ namespace Pathfinder {
          * @return Path to maps.zip in the DLL folder
          */
         std::string GetDefaultArchivePath() const;
+
+        // Memory-mapped baked maps (empty if maps.nav is missing)
+        BinaryMapPack m_pack;
     };
 
 } // namespace Pathfinder
@@ -0,0 +1,564 @@
+#include "MapJsonParser.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+using json = nlohmann::json;
+
+namespace Pathfinder {
+
+    namespace {
+
+        // Top-level keys of the map format
+        enum class Section {
+            None,
+            MapIds,
+            Points,
+            VisGraph,
+            Trapezoids,
+            Teleports,
+            TravelPortals,
+            NpcTravel,
+            EnterTravel,
+            Stats
+        };
+
+        Section SectionFromKey(const std::string& key) {
+            if (key == "map_ids") return Section::MapIds;
+            if (key == "points") return Section::Points;
+            if (key == "vis_graph") return Section::VisGraph;
+            if (key == "trapezoids") return Section::Trapezoids;
+            if (key == "teleports") return Section::Teleports;
+            if (key == "travel_portals") return Section::TravelPortals;
+            if (key == "npc_travel") return Section::NpcTravel;
+            if (key == "enter_travel") return Section::EnterTravel;
+            if (key == "stats") return Section::Stats;
+            return Section::None;
+        }
+
+        // Numeric values of the record being read (records are flat arrays of numbers)
+        struct RecordValues {
+            static constexpr size_t kCapacity = 12;
+            double values[kCapacity];
+            size_t count = 0;
+
+            void Clear() { count = 0; }
+
+            void Push(double value) {
+                if (count < kCapacity) {
+                    values[count] = value;
+                }
+                count++;
+            }
+
+            float F(size_t i) const { return static_cast<float>(values[i]); }
+            int32_t I(size_t i) const { return static_cast<int32_t>(values[i]); }
+        };
+
+        /*
+         * SAX handler writing the map format straight into MapData
+         *
+         * Depth 1 is the root object, depth 2 a section value, depth 3 a record
+         * (point, trapezoid, vis_graph row, portal, ...). vis_graph edges are arrays at
+         * depth 4 with their blocking layers at depth 5; portal connections are at depth 5.
+         * Records follow the same rules as the previous DOM parser: non-array records are
+         * skipped, short records are dropped, and non-numeric values inside a record fail the parse.
+         */
+        class MapJsonHandler : public nlohmann::json_sax<json> {
+        public:
+            explicit MapJsonHandler(MapData& out_map_data)
+                : m_map(out_map_data)
+                , m_depth(0)
+                , m_section(Section::None)
+                , m_record_active(false)
+                , m_edge_active(false)
+                , m_layers_active(false)
+                , m_connections_active(false)
+                , m_connection_active(false)
+                , m_map_id_read(false) {
+            }
+
+            bool null() override { return Scalar(); }
+            bool boolean(bool) override { return Scalar(); }
+            bool string(string_t&) override { return Scalar(); }
+            bool binary(binary_t&) override { return Scalar(); }
+
+            bool number_integer(number_integer_t val) override { return Number(static_cast<double>(val)); }
+            bool number_unsigned(number_unsigned_t val) override { return Number(static_cast<double>(val)); }
+            bool number_float(number_float_t val, const string_t&) override { return Number(val); }
+
+            bool start_object(std::size_t) override {
+                m_depth++;
+                return true;
+            }
+
+            bool key(string_t& val) override {
+                if (m_depth == 1) {
+                    m_section = SectionFromKey(val);
+                } else if (m_depth == 2 && m_section == Section::Stats) {
+                    m_stat_key = val;
+                }
+                return true;
+            }
+
+            bool end_object() override {
+                // An object in place of a vis_graph row is an empty row
+                if (m_section == Section::VisGraph && m_depth == 3) {
+                    EndRow();
+                }
+                m_depth--;
+                return true;
+            }
+
+            bool start_array(std::size_t) override {
+                m_depth++;
+
+                if (m_depth == 3) {
+                    m_record_active = true;
+                    m_values.Clear();
+                    m_connections.clear();
+                } else if (m_section == Section::VisGraph && m_depth == 4) {
+                    m_edge_active = m_record_active;
+                    m_values.Clear();
+                    m_layers.clear();
+                } else if (m_section == Section::VisGraph && m_depth == 5) {
+                    m_layers_active = m_edge_active && m_values.count >= 2;
+                } else if (m_section == Section::TravelPortals && m_depth == 4) {
+                    m_connections_active = m_record_active;
+                } else if (m_section == Section::TravelPortals && m_depth == 5) {
+                    m_connection_active = m_connections_active;
+                    m_connection_values.Clear();
+                }
+                return true;
+            }
+
+            bool end_array() override {
+                if (m_depth == 3) {
+                    if (m_record_active) {
+                        CommitRecord();
+                    }
+                    m_record_active = false;
+                } else if (m_section == Section::VisGraph && m_depth == 4) {
+                    if (m_edge_active) {
+                        CommitEdge();
+                    }
+                    m_edge_active = false;
+                } else if (m_section == Section::VisGraph && m_depth == 5) {
+                    m_layers_active = false;
+                } else if (m_section == Section::TravelPortals && m_depth == 4) {
+                    m_connections_active = false;
+                } else if (m_section == Section::TravelPortals && m_depth == 5) {
+                    if (m_connection_active && m_connection_values.count >= 3) {
+                        m_connections.emplace_back(m_connection_values.I(0), m_connection_values.F(1), m_connection_values.F(2));
+                    }
+                    m_connection_active = false;
+                }
+
+                m_depth--;
+                return true;
+            }
+
+            bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+                return false;
+            }
+
+        private:
+            bool Number(double value) {
+                switch (m_section) {
+                    case Section::MapIds:
+                        // Take the first ID from the list
+                        if (m_depth == 2 && !m_map_id_read) {
+                            m_map.map_id = static_cast<int32_t>(value);
+                            m_map_id_read = true;
+                        }
+                        break;
+
+                    case Section::VisGraph:
+                        if (m_depth == 2) {
+                            EndRow(); // A scalar in place of a row is an empty row
+                        } else if (m_depth == 4 && m_edge_active) {
+                            m_values.Push(value);
+                        } else if (m_depth == 5 && m_layers_active) {
+                            m_layers.push_back(static_cast<uint32_t>(value));
+                        }
+                        break;
+
+                    case Section::TravelPortals:
+                        if (m_depth == 3 && m_record_active) {
+                            m_values.Push(value);
+                        } else if (m_depth == 5 && m_connection_active) {
+                            m_connection_values.Push(value);
+                        }
+                        break;
+
+                    case Section::Stats:
+                        if (m_depth == 2) {
+                            SetStat(static_cast<int32_t>(value));
+                        }
+                        break;
+
+                    case Section::Points:
+                    case Section::Trapezoids:
+                    case Section::Teleports:
+                    case Section::NpcTravel:
+                    case Section::EnterTravel:
+                        if (m_depth == 3 && m_record_active) {
+                            m_values.Push(value);
+                        }
+                        break;
+
+                    case Section::None:
+                        break;
+                }
+                return true;
+            }
+
+            bool Scalar() {
+                if (m_section == Section::VisGraph && m_depth == 2) {
+                    EndRow();
+                    return true;
+                }
+
+                // Non-numeric values inside a record are malformed data
+                bool in_record = (m_depth == 3 && m_record_active) ||
+                                 (m_depth == 4 && m_edge_active) ||
+                                 (m_depth == 5 && (m_layers_active || m_connection_active));
+                return !in_record;
+            }
+
+            void CommitRecord() {
+                const RecordValues& v = m_values;
+
+                switch (m_section) {
+                    case Section::Points:
+                        // Format: [id, x, y, layer]
+                        if (v.count >= 3) {
+                            m_map.points.emplace_back(v.I(0), v.F(1), v.F(2), v.count >= 4 ? v.I(3) : 0);
+                        }
+                        break;
+
+                    case Section::VisGraph:
+                        EndRow();
+                        break;
+
+                    case Section::Trapezoids:
+                        // Format: [id, layer, ax, ay, bx, by, cx, cy, dx, dy]
+                        if (v.count >= 10) {
+                            m_map.trapezoids.emplace_back(v.I(0), v.I(1), v.F(2), v.F(3), v.F(4), v.F(5),
+                                                          v.F(6), v.F(7), v.F(8), v.F(9));
+                        }
+                        break;
+
+                    case Section::Teleports:
+                        // Format: [enterX, enterY, enterLayer, exitX, exitY, exitLayer, direction]
+                        if (v.count >= 6) {
+                            m_map.teleporters.emplace_back(v.F(0), v.F(1), v.F(3), v.F(4), v.count >= 7 ? v.I(6) : 0);
+                        }
+                        break;
+
+                    case Section::TravelPortals:
+                        // Format: [x, y, [[map_id, dest_x, dest_y], ...]]
+                        if (v.count >= 2) {
+                            TravelPortal tp(v.F(0), v.F(1));
+                            tp.connections = m_connections;
+                            m_map.travel_portals.push_back(std::move(tp));
+                        }
+                        break;
+
+                    case Section::NpcTravel:
+                        // Format: [npcX, npcY, dialogid1, dialogid2, dialogid3, dialogid4, dialogid5, mapid, posX, posY]
+                        if (v.count >= 10) {
+                            m_map.npc_travels.emplace_back(v.F(0), v.F(1), v.I(2), v.I(3), v.I(4), v.I(5), v.I(6),
+                                                           v.I(7), v.F(8), v.F(9));
+                        }
+                        break;
+
+                    case Section::EnterTravel:
+                        // Format: [enterX, enterY, mapid, destX, destY]
+                        if (v.count >= 5) {
+                            m_map.enter_travels.emplace_back(v.F(0), v.F(1), v.I(2), v.F(3), v.F(4));
+                        }
+                        break;
+
+                    case Section::MapIds:
+                    case Section::Stats:
+                    case Section::None:
+                        break;
+                }
+            }
+
+            // Edges are appended to the current CSR row: [target_id, distance, [blocking layers]]
+            void CommitEdge() {
+                if (m_values.count < 2) {
+                    return;
+                }
+
+                VisibilityGraph& graph = m_map.visibility_graph;
+                if (!m_layers.empty()) {
+                    graph.blocking_edges.push_back(static_cast<uint32_t>(graph.targets.size()));
+                    graph.blocking_layers.insert(graph.blocking_layers.end(), m_layers.begin(), m_layers.end());
+                    graph.blocking_offsets.push_back(static_cast<uint32_t>(graph.blocking_layers.size()));
+                }
+
+                graph.targets.push_back(m_values.I(0));
+                graph.distances.push_back(m_values.F(1));
+            }
+
+            void EndRow() {
+                m_map.visibility_graph.offsets.push_back(static_cast<uint32_t>(m_map.visibility_graph.targets.size()));
+            }
+
+            void SetStat(int32_t value) {
+                MapStatistics& stats = m_map.stats;
+                if (m_stat_key == "trapezoid_count") stats.trapezoid_count = value;
+                else if (m_stat_key == "point_count") stats.point_count = value;
+                else if (m_stat_key == "teleport_count") stats.teleport_count = value;
+                else if (m_stat_key == "travel_portal_count") stats.travel_portal_count = value;
+                else if (m_stat_key == "npc_travel_count") stats.npc_travel_count = value;
+                else if (m_stat_key == "enter_travel_count") stats.enter_travel_count = value;
+            }
+
+            MapData& m_map;
+            int32_t m_depth;
+            Section m_section;
+            std::string m_stat_key;
+
+            bool m_record_active;
+            bool m_edge_active;
+            bool m_layers_active;
+            bool m_connections_active;
+            bool m_connection_active;
+            bool m_map_id_read;
+
+            RecordValues m_values;
+            RecordValues m_connection_values;
+            std::vector<uint32_t> m_layers;
+            std::vector<PortalConnection> m_connections;
+        };
+
+        // The stats block sits at the end of the file: read it first, on its own, to size the vectors
+        void ReserveFromStats(const std::string& json_data, MapData& out_map_data) {
+            size_t key_pos = json_data.rfind("\"stats\"");
+            if (key_pos == std::string::npos) {
+                return;
+            }
+
+            size_t begin = json_data.find('{', key_pos);
+            size_t end = json_data.find('}', begin);
+            if (begin == std::string::npos || end == std::string::npos) {
+                return;
+            }
+
+            json stats = json::parse(json_data.begin() + begin, json_data.begin() + end + 1, nullptr, false);
+            if (!stats.is_object()) {
+                return;
+            }
+
+            auto count = [&stats](const char* name) -> size_t {
+                auto it = stats.find(name);
+                if (it == stats.end() || !it->is_number_integer()) {
+                    return 0;
+                }
+                int64_t value = it->get<int64_t>();
+                return value > 0 ? static_cast<size_t>(std::min<int64_t>(value, 1 << 24)) : 0;
+            };
+
+            const size_t point_count = count("point_count");
+            out_map_data.points.reserve(point_count);
+            out_map_data.trapezoids.reserve(count("trapezoid_count"));
+            out_map_data.teleporters.reserve(count("teleport_count"));
+            out_map_data.travel_portals.reserve(count("travel_portal_count"));
+            out_map_data.npc_travels.reserve(count("npc_travel_count"));
+            out_map_data.enter_travels.reserve(count("enter_travel_count"));
+
+            // Shipped maps average about 9 edges per point
+            out_map_data.visibility_graph.offsets.reserve(point_count + 3);
+            out_map_data.visibility_graph.targets.reserve(point_count * 9);
+            out_map_data.visibility_graph.distances.reserve(point_count * 9);
+        }
+
+        // Gives the graph exactly one row per point and drops edges to unknown points,
+        // so the search never has to bounds-check a target
+        void FinalizeVisibilityGraph(MapData& map_data) {
+            VisibilityGraph& graph = map_data.visibility_graph;
+            if (graph.offsets.size() <= 1) {
+                graph = VisibilityGraph();
+                return;
+            }
+
+            const size_t point_count = map_data.points.size();
+            const size_t row_count = graph.offsets.size() - 1;
+            if (row_count > point_count) {
+                graph.offsets.resize(point_count + 1);
+            } else {
+                graph.offsets.resize(point_count + 1, graph.offsets.back());
+            }
+
+            // Compact the edges, remapping the blocking side table
+            std::vector<uint32_t> offsets(point_count + 1, 0);
+            std::vector<uint32_t> blocking_edges;
+            std::vector<uint32_t> blocking_offsets(1, 0);
+            std::vector<uint32_t> blocking_layers;
+            size_t blocking_slot = 0;
+            uint32_t write = 0;
+
+            for (size_t row = 0; row < point_count; ++row) {
+                for (uint32_t e = graph.offsets[row]; e < graph.offsets[row + 1]; ++e) {
+                    while (blocking_slot < graph.blocking_edges.size() && graph.blocking_edges[blocking_slot] < e) {
+                        blocking_slot++;
+                    }
+
+                    const int32_t target = graph.targets[e];
+                    if (target < 0 || static_cast<size_t>(target) >= point_count) {
+                        continue;
+                    }
+
+                    if (blocking_slot < graph.blocking_edges.size() && graph.blocking_edges[blocking_slot] == e) {
+                        blocking_edges.push_back(write);
+                        blocking_layers.insert(blocking_layers.end(),
+                                               graph.blocking_layers.begin() + graph.blocking_offsets[blocking_slot],
+                                               graph.blocking_layers.begin() + graph.blocking_offsets[blocking_slot + 1]);
+                        blocking_offsets.push_back(static_cast<uint32_t>(blocking_layers.size()));
+                    }
+
+                    graph.targets[write] = target;
+                    graph.distances[write] = graph.distances[e];
+                    write++;
+                }
+                offsets[row + 1] = write;
+            }
+
+            graph.offsets.swap(offsets);
+            graph.targets.resize(write);
+            graph.distances.resize(write);
+            graph.blocking_edges.swap(blocking_edges);
+            graph.blocking_offsets.swap(blocking_offsets);
+            graph.blocking_layers.swap(blocking_layers);
+
+            // Give back a badly over-estimated reservation
+            if (graph.targets.capacity() > graph.targets.size() + graph.targets.size() / 4) {
+                graph.targets.shrink_to_fit();
+                graph.distances.shrink_to_fit();
+            }
+        }
+
+        // Graph point lying exactly at a position (-1 if none)
+        int32_t FindPointAt(const MapData& map_data, const Vec2f& pos) {
+            int32_t best = -1;
+            float best_distance_sq = 1.0f;
+            for (size_t i = 0; i < map_data.points.size(); ++i) {
+                const float distance_sq = map_data.points[i].pos.SquaredDistance(pos);
+                if (distance_sq < best_distance_sq) {
+                    best = static_cast<int32_t>(i);
+                    best_distance_sq = distance_sq;
+                }
+            }
+            return best;
+        }
+
+        // Turns every teleporter whose ends are graph points into edges of kTeleporterCost:
+        // enter -> exit, plus exit -> enter for both-ways teleporters. A walking edge the map file
+        // already has in the direction of a hop is replaced by it; the other direction of a one-way
+        // teleporter keeps its walking edge. Teleporters with an end that is not a graph point cannot
+        // be taken and are counted in stats.unconnected_teleport_count
+        void ConnectTeleporters(MapData& map_data) {
+            VisibilityGraph& graph = map_data.visibility_graph;
+            const int32_t point_count = graph.NodeCount();
+            if (map_data.teleporters.empty()) {
+                return;
+            }
+
+            std::vector<std::pair<int32_t, int32_t>> hops;          // (from, to), sorted
+            int32_t unconnected = 0;
+            for (const auto& tp : map_data.teleporters) {
+                const int32_t enter = FindPointAt(map_data, tp.enter);
+                const int32_t exit = FindPointAt(map_data, tp.exit);
+                if (enter < 0 || exit < 0 || enter == exit || enter >= point_count || exit >= point_count) {
+                    unconnected++;
+                    continue;
+                }
+
+                hops.emplace_back(enter, exit);
+                if (tp.direction == 1) {
+                    hops.emplace_back(exit, enter);
+                }
+            }
+            map_data.stats.unconnected_teleport_count = unconnected;
+            if (hops.empty()) {
+                return;
+            }
+            std::sort(hops.begin(), hops.end());
+            hops.erase(std::unique(hops.begin(), hops.end()), hops.end());
+
+            // Rebuild the CSR arrays, remapping the blocking side table of the edges that are kept
+            std::vector<uint32_t> offsets(point_count + 1, 0);
+            std::vector<int32_t> targets;
+            std::vector<float> distances;
+            std::vector<uint32_t> blocking_edges;
+            std::vector<uint32_t> blocking_offsets(1, 0);
+            std::vector<uint32_t> blocking_layers;
+            targets.reserve(graph.targets.size() + hops.size());
+            distances.reserve(graph.targets.size() + hops.size());
+            size_t blocking_slot = 0;
+            size_t hop = 0;
+
+            for (int32_t row = 0; row < point_count; ++row) {
+                for (uint32_t e = graph.offsets[row]; e < graph.offsets[row + 1]; ++e) {
+                    while (blocking_slot < graph.blocking_edges.size() && graph.blocking_edges[blocking_slot] < e) {
+                        blocking_slot++;
+                    }
+
+                    if (std::binary_search(hops.begin(), hops.end(), std::make_pair(row, graph.targets[e]))) {
+                        continue;
+                    }
+
+                    if (blocking_slot < graph.blocking_edges.size() && graph.blocking_edges[blocking_slot] == e) {
+                        blocking_edges.push_back(static_cast<uint32_t>(targets.size()));
+                        blocking_layers.insert(blocking_layers.end(),
+                                               graph.blocking_layers.begin() + graph.blocking_offsets[blocking_slot],
+                                               graph.blocking_layers.begin() + graph.blocking_offsets[blocking_slot + 1]);
+                        blocking_offsets.push_back(static_cast<uint32_t>(blocking_layers.size()));
+                    }
+                    targets.push_back(graph.targets[e]);
+                    distances.push_back(graph.distances[e]);
+                }
+
+                for (; hop < hops.size() && hops[hop].first == row; ++hop) {
+                    targets.push_back(hops[hop].second);
+                    distances.push_back(kTeleporterCost);
+                }
+                offsets[row + 1] = static_cast<uint32_t>(targets.size());
+            }
+
+            graph.offsets.swap(offsets);
+            graph.targets.swap(targets);
+            graph.distances.swap(distances);
+            graph.blocking_edges.swap(blocking_edges);
+            graph.blocking_offsets.swap(blocking_offsets);
+            graph.blocking_layers.swap(blocking_layers);
+        }
+
+    } // namespace
+
+    bool ParseMapJsonStreaming(const std::string& json_data, MapData& out_map_data) {
+        try {
+            ReserveFromStats(json_data, out_map_data);
+
+            VisibilityGraph& graph = out_map_data.visibility_graph;
+            graph.offsets.push_back(0);
+            graph.blocking_offsets.push_back(0);
+
+            MapJsonHandler handler(out_map_data);
+            if (!json::sax_parse(json_data, &handler)) {
+                return false;
+            }
+
+            FinalizeVisibilityGraph(out_map_data);
+            ConnectTeleporters(out_map_data);
+            return true;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+
+} // namespace Pathfinder
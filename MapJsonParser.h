@@ -0,0 +1,22 @@
+#pragma once
+
+#include "PathfinderCore.h"
+#include <string>
+
+namespace Pathfinder {
+
+    /**
+     * @brief Streaming parser for the map JSON format
+     *
+     * The JSON text is read with SAX callbacks that write straight into MapData,
+     * without ever building a JSON document tree. Vectors are pre-reserved from the
+     * "stats" block when the file has one. Teleporters are turned into graph edges
+     * (see kTeleporterCost).
+     *
+     * @param json_data JSON text of the map
+     * @param out_map_data Receives the map (spatial indexes are not built)
+     * @return true if the text is valid JSON and produced a usable map
+     */
+    bool ParseMapJsonStreaming(const std::string& json_data, MapData& out_map_data);
+
+} // namespace Pathfinder
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace Pathfinder {
+
+    /**
+     * @brief Open set of a search: nodes waiting to be expanded, smallest priority first
+     *
+     * Two layouts, chosen per thread before a search:
+     * - indexed 4-ary heap (default): one entry per node, whose priority is lowered in place
+     *   (decrease-key), so no node is ever popped twice for the same cost. The position of every
+     *   node in the heap is kept in an array sized to the graph.
+     * - binary heap: every improvement pushes another entry, the outdated ones stay in the heap and
+     *   are popped later. Kept as the previous behaviour, for benchmarking: the searches do not tell
+     *   outdated entries apart and expand their node again.
+     *
+     * Both pop the same node first (ties go to the lowest node ID), so searches give the same paths.
+     */
+    class OpenSet {
+    public:
+        using Entry = std::pair<float, int32_t>; // (priority, node_id)
+
+        OpenSet() : m_indexed(true) {}
+
+        bool Indexed() const {
+            return m_indexed;
+        }
+
+        // Selects the layout of the next searches (empties the set)
+        void SetIndexed(bool indexed) {
+            if (indexed != m_indexed) {
+                Clear();
+                m_indexed = indexed;
+            }
+        }
+
+        // Starts a new search over node_count nodes (buffers only grow, never shrink)
+        void Begin(int32_t node_count) {
+            Clear();
+            if (m_indexed && m_positions.size() < static_cast<size_t>(node_count)) {
+                m_positions.resize(node_count, -1);
+            }
+        }
+
+        bool Empty() const {
+            return m_entries.empty();
+        }
+
+        size_t Size() const {
+            return m_entries.size();
+        }
+
+        // Smallest priority (the set must not be empty)
+        float MinPriority() const {
+            return m_entries.front().first;
+        }
+
+        // Adds a node, or lowers its priority if it is already there (indexed layout)
+        void Push(float priority, int32_t id) {
+            if (!m_indexed) {
+                m_entries.emplace_back(priority, id);
+                std::push_heap(m_entries.begin(), m_entries.end(), std::greater<Entry>());
+                return;
+            }
+
+            const Entry entry(priority, id);
+            int32_t position = m_positions[id];
+            if (position < 0) {
+                position = static_cast<int32_t>(m_entries.size());
+                m_entries.push_back(entry);
+            }
+            else if (!(entry < m_entries[position])) {
+                return;
+            }
+            SiftUp(position, entry);
+        }
+
+        // Removes and returns the entry of smallest priority (the set must not be empty)
+        Entry Pop() {
+            if (!m_indexed) {
+                std::pop_heap(m_entries.begin(), m_entries.end(), std::greater<Entry>());
+                const Entry top = m_entries.back();
+                m_entries.pop_back();
+                return top;
+            }
+
+            const Entry top = m_entries.front();
+            m_positions[top.second] = -1;
+            const Entry last = m_entries.back();
+            m_entries.pop_back();
+            if (!m_entries.empty()) {
+                SiftDown(0, last);
+            }
+            return top;
+        }
+
+        void Clear() {
+            if (m_indexed) {
+                for (const auto& entry : m_entries) {
+                    m_positions[entry.second] = -1;
+                }
+            }
+            m_entries.clear();
+        }
+
+    private:
+        static constexpr int32_t kArity = 4;
+
+        // Moves entry from position towards the root until its parent is smaller
+        void SiftUp(int32_t position, const Entry& entry) {
+            while (position > 0) {
+                const int32_t parent = (position - 1) / kArity;
+                if (!(entry < m_entries[parent])) {
+                    break;
+                }
+                Place(position, m_entries[parent]);
+                position = parent;
+            }
+            Place(position, entry);
+        }
+
+        // Moves entry from position towards the leaves until its children are larger
+        void SiftDown(int32_t position, const Entry& entry) {
+            const int32_t count = static_cast<int32_t>(m_entries.size());
+            for (;;) {
+                const int32_t first = position * kArity + 1;
+                if (first >= count) {
+                    break;
+                }
+                const int32_t end = std::min(first + kArity, count);
+                int32_t smallest = first;
+                for (int32_t child = first + 1; child < end; ++child) {
+                    if (m_entries[child] < m_entries[smallest]) {
+                        smallest = child;
+                    }
+                }
+                if (!(m_entries[smallest] < entry)) {
+                    break;
+                }
+                Place(position, m_entries[smallest]);
+                position = smallest;
+            }
+            Place(position, entry);
+        }
+
+        void Place(int32_t position, const Entry& entry) {
+            m_entries[position] = entry;
+            m_positions[entry.second] = position;
+        }
+
+        bool m_indexed;
+        std::vector<Entry> m_entries;
+        std::vector<int32_t> m_positions;   // Position of each node in m_entries (-1 if not there)
+    };
+
+} // namespace Pathfinder
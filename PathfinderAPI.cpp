@@ -1,25 +1,218 @@
 #include "PathfinderAPI.h"
 #include "PathfinderCore.h"
 #include "MapDataRegistry.h"
+#include "BinaryMapFormat.h"
+#include "ThreadPool.h"
+#include "WorldGraph.h"
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 // Global pathfinding engine instance
-static std::unique_ptr<Pathfinder::PathfinderEngine> g_engine;
-static bool g_initialized = false;
+// Published atomically: every call works on its own reference, so Shutdown never pulls
+// the engine from under a running query
+static std::shared_ptr<Pathfinder::PathfinderEngine> g_engine;
+static std::atomic<bool> g_initialized(false);
+static std::mutex g_init_mutex;
+
+// Transitions of every baked map, built on the first world route and dropped with the engine
+static std::shared_ptr<const Pathfinder::WorldGraph> g_world_graph;
+static std::mutex g_world_graph_mutex;
+
+// Map source of the engine: prefers the baked pack (no parse step) over the JSON archive
+static Pathfinder::MapLoadStatus LoadMapFromRegistry(int32_t map_id, Pathfinder::MapData& out_map_data) {
+    auto& registry = Pathfinder::MapDataRegistry::GetInstance();
+
+    const uint8_t* baked_data = nullptr;
+    size_t baked_size = 0;
+    if (registry.GetBakedMapData(map_id, baked_data, baked_size)) {
+        if (Pathfinder::PathfinderEngine::BuildMapFromBinary(map_id, baked_data, baked_size, out_map_data)) {
+            return Pathfinder::MapLoadStatus::Loaded;
+        }
+        out_map_data = Pathfinder::MapData();
+    }
+
+    std::string map_data = registry.GetMapData(map_id);
+    if (map_data.empty()) {
+        return Pathfinder::MapLoadStatus::NotFound;
+    }
+
+    return Pathfinder::PathfinderEngine::BuildMapFromJson(map_id, map_data, out_map_data)
+        ? Pathfinder::MapLoadStatus::Loaded
+        : Pathfinder::MapLoadStatus::Failed;
+}
+
+// Worker pool of the batch API, created on first use
+// Never destroyed: its threads must not be joined from DllMain (loader lock)
+static Pathfinder::ThreadPool& GetBatchPool() {
+    static Pathfinder::ThreadPool* pool = new Pathfinder::ThreadPool(
+        std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return *pool;
+}
+
+// Background map loaders used by PrefetchMap and neighbour warming (low priority), created on first use
+// Loads are decompression and parsing bound: two loaders let a prefetch run next to another one
+// Never destroyed, for the same reason as the batch pool
+static Pathfinder::ThreadPool& GetLoaderPool() {
+    static Pathfinder::ThreadPool* pool = new Pathfinder::ThreadPool(2);
+    return *pool;
+}
+
+// Clears a result before it is filled
+static void ResetPathResult(PathResult& result) {
+    result.points = nullptr;
+    result.point_count = 0;
+    result.total_cost = -1.0f;
+    result.error_code = 0;
+    result.error_message[0] = '\0';
+}
+
+// Reports a map that could not be acquired
+static void SetMapLoadError(PathResult& result, int32_t map_id, Pathfinder::MapLoadStatus status) {
+    result.error_code = 1;
+    if (status == Pathfinder::MapLoadStatus::NotFound) {
+        std::snprintf(result.error_message, 255, "Map %d not found in archive", map_id);
+    }
+    else {
+        std::snprintf(result.error_message, 255, "Failed to load map %d", map_id);
+    }
+}
+
+// Runs one query on a map held by the caller
+// Fills path and sets total_cost, or returns false and sets the error of the result
+static bool RunPathQuery(
+    Pathfinder::PathfinderEngine& engine,
+    const Pathfinder::MapData& map_data,
+    const PathQuery& query,
+    std::vector<Pathfinder::PathPointWithLayer>& path,
+    PathResult& result
+) {
+    try {
+        // Convert API obstacles to internal format (buffer reused by each thread)
+        thread_local std::vector<Pathfinder::ObstacleZone> internal_obstacles;
+        internal_obstacles.clear();
+        if (query.obstacles != nullptr && query.obstacle_count > 0) {
+            internal_obstacles.reserve(query.obstacle_count);
+            for (int32_t i = 0; i < query.obstacle_count; ++i) {
+                internal_obstacles.emplace_back(
+                    query.obstacles[i].x,
+                    query.obstacles[i].y,
+                    query.obstacles[i].radius
+                );
+            }
+        }
+
+        // Find the path with obstacle avoidance
+        Pathfinder::Vec2f start(query.start_x, query.start_y);
+        Pathfinder::Vec2f goal(query.dest_x, query.dest_y);
+        float cost = 0.0f;
+
+        // Use pathfinding with obstacle avoidance (pass start_layer, -1 means auto-detect)
+        if (!engine.FindPathWithObstacles(map_data, start, query.start_layer, goal, internal_obstacles, path, cost)
+            || path.empty()) {
+            result.error_code = 2;
+            std::strncpy(result.error_message, "No path found", 255);
+            return false;
+        }
+
+        // Simplify the path if requested
+        if (query.range > 0.0f) {
+            engine.SimplifyPathInPlace(path, query.range);
+        }
+
+        result.total_cost = cost;
+        return true;
+    }
+    catch (const std::exception& e) {
+        result.error_code = -2;
+        std::snprintf(result.error_message, 255, "Exception: %s", e.what());
+    }
+    catch (...) {
+        result.error_code = -3;
+        std::strncpy(result.error_message, "Unknown exception", 255);
+    }
+    path.clear();
+    return false;
+}
+
+static void CopyPathPoints(const std::vector<Pathfinder::PathPointWithLayer>& path, PathPoint* out_points) {
+    for (size_t i = 0; i < path.size(); ++i) {
+        out_points[i].x = path[i].pos.x;
+        out_points[i].y = path[i].pos.y;
+        out_points[i].layer = path[i].layer;
+    }
+}
+
+// Returns the engine, initializing the DLL on first use (nullptr if initialization failed)
+static std::shared_ptr<Pathfinder::PathfinderEngine> AcquireEngine() {
+    if (!g_initialized.load(std::memory_order_acquire)) {
+        Initialize();
+    }
+    return std::atomic_load(&g_engine);
+}
+
+// Returns the world graph, building it from the baked pack on first use
+// Only the travel sections of each map are read: no map is loaded
+static std::shared_ptr<const Pathfinder::WorldGraph> AcquireWorldGraph() {
+    std::lock_guard<std::mutex> lock(g_world_graph_mutex);
+    if (!g_world_graph) {
+        auto& registry = Pathfinder::MapDataRegistry::GetInstance();
+        auto world = std::make_shared<Pathfinder::WorldGraph>();
+        for (int32_t map_id : registry.GetAvailableMapIds()) {
+            const uint8_t* baked_data = nullptr;
+            size_t baked_size = 0;
+            Pathfinder::MapData travel_data;
+            if (registry.GetBakedMapData(map_id, baked_data, baked_size) &&
+                Pathfinder::ReadBinaryTravelData(baked_data, baked_size, travel_data)) {
+                travel_data.map_id = map_id;
+                world->AddMap(travel_data);
+            }
+        }
+        world->Link();
+        g_world_graph = std::move(world);
+    }
+    return g_world_graph;
+}
+
+// Drops the engine; wait_for_loads lets prefetches still reading the registry finish first
+// (never from DllMain: at process exit the loader threads are already gone)
+static void ShutdownEngine(bool wait_for_loads) {
+    std::shared_ptr<Pathfinder::PathfinderEngine> engine;
+    {
+        std::lock_guard<std::mutex> lock(g_init_mutex);
+        if (!g_initialized.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        engine = std::atomic_exchange(&g_engine, std::shared_ptr<Pathfinder::PathfinderEngine>());
+        g_initialized.store(false, std::memory_order_release);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_world_graph_mutex);
+        g_world_graph.reset();
+    }
+
+    if (engine && wait_for_loads) {
+        engine->WaitForLoads();
+    }
+}
 
 extern "C" {
 
     PATHFINDER_API int32_t Initialize() {
-        if (g_initialized) {
+        std::lock_guard<std::mutex> lock(g_init_mutex);
+
+        if (g_initialized.load(std::memory_order_acquire)) {
             return 1; // Already initialized
         }
 
         try {
-            g_engine = std::make_unique<Pathfinder::PathfinderEngine>();
-
             // Initialize the map registry (loads from maps.zip)
             auto& registry = Pathfinder::MapDataRegistry::GetInstance();
             if (!registry.Initialize()) {
@@ -29,8 +222,17 @@ extern "C" {
 
             // Note: Maps will be loaded on demand (lazy loading)
             // when FindPath is called
-
-            g_initialized = true;
+            auto engine = std::make_shared<Pathfinder::PathfinderEngine>();
+            engine->SetMapSource(LoadMapFromRegistry);
+            engine->SetBackgroundScheduler([](std::function<void()> task) {
+                GetLoaderPool().SubmitLowPriority(std::move(task));
+            });
+            engine->SetSearchScheduler([](std::function<void()> task) {
+                GetBatchPool().Submit(std::move(task));
+            });
+
+            std::atomic_store(&g_engine, engine);
+            g_initialized.store(true, std::memory_order_release);
             return 1;
         }
         catch (...) {
@@ -39,10 +241,7 @@ extern "C" {
     }
 
     PATHFINDER_API void Shutdown() {
-        if (g_initialized) {
-            g_engine.reset();
-            g_initialized = false;
-        }
+        ShutdownEngine(true);
     }
 
     PATHFINDER_API PathResult* FindPathWithObstacles(
@@ -56,90 +255,321 @@ extern "C" {
         int32_t obstacle_count,
         float range
     ) {
+        PathResult* result = new PathResult();
+        ResetPathResult(*result);
+
         // Auto-initialize if necessary
-        if (!g_initialized) {
-            if (!Initialize()) {
-                PathResult* result = new PathResult();
-                result->points = nullptr;
-                result->point_count = 0;
-                result->total_cost = -1.0f;
-                result->error_code = -1;
-                std::strncpy(result->error_message, "Failed to initialize pathfinder", 255);
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (!engine) {
+            result->error_code = -1;
+            std::strncpy(result->error_message, "Failed to initialize pathfinder", 255);
+            return result;
+        }
+
+        try {
+            // Get the map, loading it from the archive if necessary
+            // (threads asking for the same map at the same time share one load)
+            Pathfinder::MapLoadStatus load_status = Pathfinder::MapLoadStatus::Loaded;
+            std::shared_ptr<const Pathfinder::MapData> map_data = engine->AcquireMap(map_id, &load_status);
+
+            if (!map_data) {
+                SetMapLoadError(*result, map_id, load_status);
                 return result;
             }
+
+            PathQuery query = { map_id, start_x, start_y, start_layer, dest_x, dest_y, obstacles, obstacle_count, range };
+            // Path buffer reused by each thread
+            thread_local std::vector<Pathfinder::PathPointWithLayer> path;
+            if (!RunPathQuery(*engine, *map_data, query, path, *result)) {
+                return result;
+            }
+
+            // Allocate and copy the points
+            result->point_count = static_cast<int32_t>(path.size());
+            result->points = new PathPoint[result->point_count];
+            CopyPathPoints(path, result->points);
+
+            return result;
+        }
+        catch (const std::exception& e) {
+            result->error_code = -2;
+            std::snprintf(result->error_message, 255, "Exception: %s", e.what());
+            return result;
+        }
+        catch (...) {
+            result->error_code = -3;
+            std::strncpy(result->error_message, "Unknown exception", 255);
+            return result;
         }
+    }
 
-        PathResult* result = new PathResult();
-        result->points = nullptr;
-        result->point_count = 0;
-        result->total_cost = -1.0f;
-        result->error_code = 0;
-        result->error_message[0] = '\0';
+    PATHFINDER_API int32_t FindPathsBatch(const PathQuery* queries, int32_t count, PathResult* out_results) {
+        if (!queries || !out_results || count < 0) {
+            return -1;
+        }
+
+        for (int32_t i = 0; i < count; ++i) {
+            ResetPathResult(out_results[i]);
+        }
+
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (!engine) {
+            for (int32_t i = 0; i < count; ++i) {
+                out_results[i].error_code = -1;
+                std::strncpy(out_results[i].error_message, "Failed to initialize pathfinder", 255);
+            }
+            return -1;
+        }
 
         try {
-            // Check if the map is loaded, otherwise load it from the archive
-            if (!g_engine->IsMapLoaded(map_id)) {
-                auto& registry = Pathfinder::MapDataRegistry::GetInstance();
-                std::string map_data = registry.GetMapData(map_id);
-
-                if (map_data.empty()) {
-                    result->error_code = 1;
-                    std::snprintf(result->error_message, 255, "Map %d not found in archive", map_id);
-                    return result;
+            // Group the queries by map: each map is acquired once, and the queries of a map
+            // run next to each other so its data stays hot in the workers' caches
+            std::vector<int32_t> order(count);
+            for (int32_t i = 0; i < count; ++i) {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [queries](int32_t a, int32_t b) {
+                return queries[a].map_id < queries[b].map_id;
+            });
+
+            std::vector<int32_t> group_maps;
+            std::vector<uint32_t> query_group(count);
+            for (int32_t k = 0; k < count; ++k) {
+                const int32_t map_id = queries[order[k]].map_id;
+                if (group_maps.empty() || group_maps.back() != map_id) {
+                    group_maps.push_back(map_id);
                 }
+                query_group[k] = static_cast<uint32_t>(group_maps.size() - 1);
+            }
+
+            Pathfinder::ThreadPool& pool = GetBatchPool();
 
-                // Load the map into the engine
-                if (!g_engine->LoadMapData(map_id, map_data)) {
-                    result->error_code = 1;
-                    std::snprintf(result->error_message, 255, "Failed to load map %d", map_id);
-                    return result;
+            // Missing maps are loaded in parallel
+            std::vector<std::shared_ptr<const Pathfinder::MapData>> group_data(group_maps.size());
+            std::vector<Pathfinder::MapLoadStatus> group_status(group_maps.size(), Pathfinder::MapLoadStatus::Failed);
+            pool.ParallelFor(group_maps.size(), [&](size_t g) {
+                try {
+                    group_data[g] = engine->AcquireMap(group_maps[g], &group_status[g]);
+                }
+                catch (...) {
+                    group_status[g] = Pathfinder::MapLoadStatus::Failed;
+                }
+            });
+
+            // The sorted queries run in a few chunks per thread. Each path is found in a buffer reused
+            // by its thread and appended to the points of its chunk, so no query allocates on its own
+            const size_t chunk_count = std::min(static_cast<size_t>(count), (pool.WorkerCount() + 1) * 4);
+            std::vector<std::vector<PathPoint>> chunk_points(chunk_count);
+            std::vector<uint32_t> query_chunk(count);
+            std::vector<size_t> query_offset(count);
+            pool.ParallelFor(chunk_count, [&](size_t c) {
+                thread_local std::vector<Pathfinder::PathPointWithLayer> path;
+                std::vector<PathPoint>& staged = chunk_points[c];
+                const size_t end = (c + 1) * count / chunk_count;
+                for (size_t k = c * count / chunk_count; k < end; ++k) {
+                    const int32_t index = order[k];
+                    const uint32_t group = query_group[k];
+                    if (!group_data[group]) {
+                        SetMapLoadError(out_results[index], group_maps[group], group_status[group]);
+                        continue;
+                    }
+
+                    try {
+                        if (!RunPathQuery(*engine, *group_data[group], queries[index], path, out_results[index])) {
+                            continue;
+                        }
+
+                        query_chunk[index] = static_cast<uint32_t>(c);
+                        query_offset[index] = staged.size();
+                        staged.resize(staged.size() + path.size());
+                        CopyPathPoints(path, staged.data() + query_offset[index]);
+                        out_results[index].point_count = static_cast<int32_t>(path.size());
+                    }
+                    catch (const std::exception& e) {
+                        out_results[index].error_code = -2;
+                        std::snprintf(out_results[index].error_message, 255, "Exception: %s", e.what());
+                    }
                 }
+            });
+
+            // One allocation holds the points of the whole batch, laid out in query order
+            size_t total_points = 0;
+            for (const auto& staged : chunk_points) {
+                total_points += staged.size();
             }
 
-            // Convert API obstacles to internal format
-            std::vector<Pathfinder::ObstacleZone> internal_obstacles;
-            if (obstacles != nullptr && obstacle_count > 0) {
-                internal_obstacles.reserve(obstacle_count);
-                for (int32_t i = 0; i < obstacle_count; ++i) {
-                    internal_obstacles.emplace_back(
-                        obstacles[i].x,
-                        obstacles[i].y,
-                        obstacles[i].radius
-                    );
+            PathPoint* points = total_points > 0 ? new PathPoint[total_points] : nullptr;
+            int32_t found = 0;
+            for (int32_t i = 0; i < count; ++i) {
+                if (out_results[i].point_count == 0) {
+                    continue;
                 }
+
+                const PathPoint* staged = chunk_points[query_chunk[i]].data() + query_offset[i];
+                std::copy(staged, staged + out_results[i].point_count, points);
+                out_results[i].points = points;
+                points += out_results[i].point_count;
+                found++;
             }
 
-            // Find the path with obstacle avoidance
-            Pathfinder::Vec2f start(start_x, start_y);
-            Pathfinder::Vec2f goal(dest_x, dest_y);
-            float cost = 0.0f;
+            return found;
+        }
+        catch (const std::exception& e) {
+            for (int32_t i = 0; i < count; ++i) {
+                ResetPathResult(out_results[i]);
+                out_results[i].error_code = -2;
+                std::snprintf(out_results[i].error_message, 255, "Exception: %s", e.what());
+            }
+            return -1;
+        }
+        catch (...) {
+            for (int32_t i = 0; i < count; ++i) {
+                ResetPathResult(out_results[i]);
+                out_results[i].error_code = -3;
+                std::strncpy(out_results[i].error_message, "Unknown exception", 255);
+            }
+            return -1;
+        }
+    }
 
-            // Use pathfinding with obstacle avoidance (pass start_layer, -1 means auto-detect)
-            std::vector<Pathfinder::PathPointWithLayer> path =
-                g_engine->FindPathWithObstacles(map_id, start, start_layer, goal, internal_obstacles, cost);
+    PATHFINDER_API void FreePathsBatch(PathResult* results, int32_t count) {
+        if (!results) {
+            return;
+        }
 
-            if (path.empty()) {
-                result->error_code = 2;
-                std::strncpy(result->error_message, "No path found", 255);
-                return result;
+        // All the points of a batch share one block, which starts at the first result with points
+        for (int32_t i = 0; i < count; ++i) {
+            if (results[i].points) {
+                delete[] results[i].points;
+                break;
             }
+        }
+
+        for (int32_t i = 0; i < count; ++i) {
+            results[i].points = nullptr;
+            results[i].point_count = 0;
+        }
+    }
+
+    PATHFINDER_API int32_t LocatePoints(int32_t map_id, const float* xy, int32_t count,
+                                        int32_t* out_trapezoid_ids, int32_t* out_layers) {
+        if (!xy || !out_trapezoid_ids || !out_layers || count < 0) {
+            return -1;
+        }
+
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (!engine) {
+            return -1;
+        }
 
-            // Simplify the path if requested
-            if (range > 0.0f) {
-                path = g_engine->SimplifyPath(path, range);
+        try {
+            std::shared_ptr<const Pathfinder::MapData> map_data = engine->AcquireMap(map_id);
+            if (!map_data) {
+                return -2;
             }
 
-            // Allocate and copy the points
-            result->point_count = static_cast<int32_t>(path.size());
-            result->points = new PathPoint[result->point_count];
-            result->total_cost = cost;
+            return map_data->LocatePoints(xy, count, out_trapezoid_ids, out_layers);
+        }
+        catch (...) {
+            return -1;
+        }
+    }
+
+    PATHFINDER_API int32_t IsReachable(int32_t map_id, float start_x, float start_y, float goal_x, float goal_y) {
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (!engine) {
+            return -1;
+        }
+
+        try {
+            std::shared_ptr<const Pathfinder::MapData> map_data = engine->AcquireMap(map_id);
+            if (!map_data) {
+                return -2;
+            }
+
+            return engine->IsReachable(*map_data, Pathfinder::Vec2f(start_x, start_y), -1,
+                                       Pathfinder::Vec2f(goal_x, goal_y)) ? 1 : 0;
+        }
+        catch (...) {
+            return -1;
+        }
+    }
+
+    PATHFINDER_API void FreePathResult(PathResult* result) {
+        if (result) {
+            if (result->points) {
+                delete[] result->points;
+            }
+            delete result;
+        }
+    }
+
+    PATHFINDER_API WorldRouteResult* FindWorldRoute(
+        int32_t start_map_id,
+        float start_x,
+        float start_y,
+        int32_t goal_map_id,
+        float goal_x,
+        float goal_y
+    ) {
+        WorldRouteResult* result = new WorldRouteResult();
+        result->legs = nullptr;
+        result->leg_count = 0;
+        result->total_cost = -1.0f;
+        result->error_code = 0;
+        result->error_message[0] = '\0';
+
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (!engine) {
+            result->error_code = -1;
+            std::strncpy(result->error_message, "Failed to initialize pathfinder", 255);
+            return result;
+        }
 
-            for (int32_t i = 0; i < result->point_count; ++i) {
-                result->points[i].x = path[i].pos.x;
-                result->points[i].y = path[i].pos.y;
-                result->points[i].layer = path[i].layer;
+        try {
+            // Only the two ends are loaded, the maps in between are known from the world graph
+            Pathfinder::MapLoadStatus load_status = Pathfinder::MapLoadStatus::Loaded;
+            std::shared_ptr<const Pathfinder::MapData> start_map = engine->AcquireMap(start_map_id, &load_status);
+            if (!start_map) {
+                result->error_code = 1;
+                std::snprintf(result->error_message, 255, load_status == Pathfinder::MapLoadStatus::NotFound
+                              ? "Map %d not found in archive" : "Failed to load map %d", start_map_id);
+                return result;
+            }
+            std::shared_ptr<const Pathfinder::MapData> goal_map = engine->AcquireMap(goal_map_id, &load_status);
+            if (!goal_map) {
+                result->error_code = 1;
+                std::snprintf(result->error_message, 255, load_status == Pathfinder::MapLoadStatus::NotFound
+                              ? "Map %d not found in archive" : "Failed to load map %d", goal_map_id);
+                return result;
+            }
+
+            std::shared_ptr<const Pathfinder::WorldGraph> world = AcquireWorldGraph();
+            std::vector<Pathfinder::WorldRouteLeg> legs;
+            float cost = 0.0f;
+            if (!Pathfinder::FindWorldRoute(*engine, *world, *start_map, Pathfinder::Vec2f(start_x, start_y),
+                                            *goal_map, Pathfinder::Vec2f(goal_x, goal_y), legs, cost)) {
+                result->error_code = 2;
+                std::strncpy(result->error_message, "No route found", 255);
+                return result;
             }
 
+            result->leg_count = static_cast<int32_t>(legs.size());
+            result->legs = new WorldRouteLeg[legs.size()];
+            for (size_t i = 0; i < legs.size(); ++i) {
+                WorldRouteLeg& leg = result->legs[i];
+                leg.map_id = legs[i].map_id;
+                leg.start_x = legs[i].start.x;
+                leg.start_y = legs[i].start.y;
+                leg.end_x = legs[i].end.x;
+                leg.end_y = legs[i].end.y;
+                leg.cost = legs[i].cost;
+                leg.action = static_cast<int32_t>(legs[i].transition.kind);
+                std::memcpy(leg.dialog_ids, legs[i].transition.dialog_ids, sizeof(leg.dialog_ids));
+                leg.dest_map_id = legs[i].transition.dest_map_id;
+            }
+            result->total_cost = cost;
             return result;
         }
         catch (const std::exception& e) {
@@ -154,11 +584,9 @@ extern "C" {
         }
     }
 
-    PATHFINDER_API void FreePathResult(PathResult* result) {
+    PATHFINDER_API void FreeWorldRouteResult(WorldRouteResult* result) {
         if (result) {
-            if (result->points) {
-                delete[] result->points;
-            }
+            delete[] result->legs;
             delete result;
         }
     }
@@ -214,10 +642,9 @@ extern "C" {
 
     PATHFINDER_API int32_t LoadMapFromFile(int32_t map_id, const char* file_path) {
         // Auto-initialize if necessary
-        if (!g_initialized) {
-            if (!Initialize()) {
-                return 0;
-            }
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (!engine) {
+            return 0;
         }
 
         if (!file_path) {
@@ -234,10 +661,16 @@ extern "C" {
             // Read all content
             std::stringstream buffer;
             buffer << file.rdbuf();
-            std::string json_data = buffer.str();
+            std::string file_data = buffer.str();
+
+            // Baked maps are recognized by their header, anything else is parsed as JSON
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(file_data.data());
+            if (Pathfinder::IsBinaryMap(bytes, file_data.size())) {
+                return engine->LoadMapDataBinary(map_id, bytes, file_data.size()) ? 1 : 0;
+            }
 
             // Load into the engine
-            if (g_engine->LoadMapData(map_id, json_data)) {
+            if (engine->LoadMapData(map_id, file_data)) {
                 return 1;
             }
 
@@ -248,22 +681,127 @@ extern "C" {
         }
     }
 
-    PATHFINDER_API MapStats* GetMapStats(int32_t map_id) {
+    PATHFINDER_API int32_t PrefetchMap(int32_t map_id) {
         // Auto-initialize if necessary
-        if (!g_initialized) {
-            Initialize();
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (!engine) {
+            return 0;
+        }
+
+        try {
+            // Nothing to do if the map is already loaded or being loaded
+            if (!engine->BeginLoad(map_id)) {
+                return 1;
+            }
+
+            // The job keeps the engine alive until the load is published
+            try {
+                GetLoaderPool().Submit([engine, map_id]() {
+                    engine->RunLoad(map_id);
+                });
+            }
+            catch (...) {
+                // A registered load must always run, or the queries waiting on it would hang
+                engine->RunLoad(map_id);
+            }
+            return 1;
+        }
+        catch (...) {
+            return 0;
+        }
+    }
+
+    PATHFINDER_API int32_t PrefetchMaps(const int32_t* map_ids, int32_t count) {
+        if (!map_ids) {
+            return 0;
+        }
+
+        int32_t queued = 0;
+        for (int32_t i = 0; i < count; ++i) {
+            queued += PrefetchMap(map_ids[i]);
+        }
+        return queued;
+    }
+
+    PATHFINDER_API int32_t GetMapLoadState(int32_t map_id) {
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (!engine) {
+            return -1;
+        }
+
+        return static_cast<int32_t>(engine->GetMapLoadState(map_id));
+    }
+
+    PATHFINDER_API void SetMapWarming(int32_t enabled, int32_t max_fan_out, uint64_t byte_budget) {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (engine) {
+            Pathfinder::MapWarmingOptions options;
+            options.enabled = enabled != 0;
+            options.max_fan_out = max_fan_out;
+            options.byte_budget = byte_budget;
+            engine->SetMapWarming(options);
+        }
+    }
+
+    PATHFINDER_API void SetBuildContractionHierarchies(int32_t enabled) {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (engine) {
+            engine->SetBuildContractionHierarchies(enabled != 0);
+        }
+    }
+
+    PATHFINDER_API void SetBuildHierarchicalGraphs(int32_t enabled) {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (engine) {
+            engine->SetBuildHierarchicalGraphs(enabled != 0);
+        }
+    }
+
+    PATHFINDER_API void SetObstacleEdgeTest(int32_t enabled) {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (engine) {
+            engine->SetObstacleEdgeTest(enabled != 0);
         }
+    }
+
+    PATHFINDER_API void SetIndexedOpenSet(int32_t enabled) {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (engine) {
+            engine->SetIndexedOpenSet(enabled != 0);
+        }
+    }
+
+    PATHFINDER_API void SetBidirectionalSearch(int32_t enabled, float min_distance, int32_t parallel) {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (engine) {
+            Pathfinder::BidirectionalSearchOptions options;
+            options.enabled = enabled != 0;
+            options.min_distance = min_distance;
+            options.parallel = parallel != 0;
+            engine->SetBidirectionalSearch(options);
+        }
+    }
+
+    PATHFINDER_API MapStats* GetMapStats(int32_t map_id) {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
 
         MapStats* result = new MapStats();
 
-        if (!g_engine) {
+        if (!engine) {
             result->error_code = 1;
             std::snprintf(result->error_message, sizeof(result->error_message), "Pathfinder not initialized");
             return result;
         }
 
         Pathfinder::MapStatistics stats;
-        if (!g_engine->GetMapStatistics(map_id, stats)) {
+        if (!engine->GetMapStatistics(map_id, stats)) {
             result->error_code = 2;
             std::snprintf(result->error_message, sizeof(result->error_message), "Map %d not loaded", map_id);
             return result;
@@ -275,6 +813,7 @@ extern "C" {
         result->travel_portal_count = stats.travel_portal_count;
         result->npc_travel_count = stats.npc_travel_count;
         result->enter_travel_count = stats.enter_travel_count;
+        result->unconnected_teleport_count = stats.unconnected_teleport_count;
         result->error_code = 0;
         result->error_message[0] = '\0';
 
@@ -287,6 +826,86 @@ extern "C" {
         }
     }
 
+    PATHFINDER_API MapCacheStats* GetMapCacheStats() {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+
+        MapCacheStats* result = new MapCacheStats();
+
+        if (!engine) {
+            result->error_code = 1;
+            std::snprintf(result->error_message, sizeof(result->error_message), "Pathfinder not initialized");
+            return result;
+        }
+
+        Pathfinder::MapCacheStatistics stats = engine->GetMapCache().GetStatistics();
+        result->hits = stats.hits;
+        result->misses = stats.misses;
+        result->evictions = stats.evictions;
+        result->bytes_used = stats.bytes_used;
+        result->byte_budget = stats.byte_budget;
+        result->map_count = stats.map_count;
+        result->pinned_count = stats.pinned_count;
+        result->error_code = 0;
+        result->error_message[0] = '\0';
+
+        return result;
+    }
+
+    PATHFINDER_API void FreeMapCacheStats(MapCacheStats* stats) {
+        if (stats) {
+            delete stats;
+        }
+    }
+
+    PATHFINDER_API void ResetMapCacheStats() {
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = std::atomic_load(&g_engine);
+        if (engine) {
+            engine->GetMapCache().ResetCounters();
+        }
+    }
+
+    PATHFINDER_API void SetMapCacheBudget(uint64_t byte_budget) {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (engine) {
+            engine->GetMapCache().SetByteBudget(byte_budget);
+        }
+    }
+
+    PATHFINDER_API int32_t PinMap(int32_t map_id) {
+        // Auto-initialize if necessary
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = AcquireEngine();
+        if (!engine) {
+            return 0;
+        }
+
+        try {
+            // Pin first so the map cannot be evicted between its load and the pin
+            Pathfinder::MapCache& cache = engine->GetMapCache();
+            cache.Pin(map_id);
+
+            if (!engine->AcquireMap(map_id)) {
+                cache.Unpin(map_id);
+                return 0;
+            }
+
+            return 1;
+        }
+        catch (...) {
+            return 0;
+        }
+    }
+
+    PATHFINDER_API int32_t UnpinMap(int32_t map_id) {
+        std::shared_ptr<Pathfinder::PathfinderEngine> engine = std::atomic_load(&g_engine);
+        if (!engine) {
+            return 0;
+        }
+
+        return engine->GetMapCache().Unpin(map_id) ? 1 : 0;
+    }
+
 } // extern "C"
 
 // DLL Entry Point
@@ -302,7 +921,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
 
     case DLL_PROCESS_DETACH:
         // Automatic cleanup on unload
-        Shutdown();
+        ShutdownEngine(false);
         break;
 
     case DLL_THREAD_ATTACH:
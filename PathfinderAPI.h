@@ -35,6 +35,21 @@ extern "C" {
         int32_t enter_travel_count; // Number of Enter key travels
         int32_t error_code;         // 0 = success, other = error
         char error_message[256];    // Error message if applicable
+        int32_t unconnected_teleport_count; // Teleporters with an end off the graph (cannot be taken), after the
+                                            // original fields so that their offsets stay valid
+    };
+
+    // Structure for the map cache statistics
+    struct MapCacheStats {
+        uint64_t hits;              // Lookups that found the map already loaded
+        uint64_t misses;            // Lookups that had to load the map
+        uint64_t evictions;         // Maps evicted to stay within the budget
+        uint64_t bytes_used;        // Approximate memory used by the loaded maps
+        uint64_t byte_budget;       // Memory budget of the cache
+        int32_t map_count;          // Number of loaded maps
+        int32_t pinned_count;       // Number of pinned maps
+        int32_t error_code;         // 0 = success, other = error
+        char error_message[256];    // Error message if applicable
     };
 
     // Structure for an obstacle zone (circular area to avoid)
@@ -44,6 +59,41 @@ extern "C" {
         float radius;   // Radius of the obstacle zone
     };
 
+    // Structure for one query of a batch (see FindPathsBatch)
+    struct PathQuery {
+        int32_t map_id;                 // GW map ID
+        float start_x;                  // Starting X coordinate
+        float start_y;                  // Starting Y coordinate
+        int32_t start_layer;            // Layer of the starting point (-1 = auto-detect)
+        float dest_x;                   // Destination X coordinate
+        float dest_y;                   // Destination Y coordinate
+        const ObstacleZone* obstacles;  // Obstacle zones to avoid (can be NULL if obstacle_count is 0)
+        int32_t obstacle_count;         // Number of obstacles in the array
+        float range;                    // Minimum distance between simplified points (0 = no simplification)
+    };
+
+    // Structure for one leg of a world route (see FindWorldRoute)
+    struct WorldRouteLeg {
+        int32_t map_id;             // Map walked during this leg
+        float start_x;              // Where the walk starts (route start or arrival of the previous action)
+        float start_y;
+        float end_x;                // Where the walk ends (position of the action, or route goal)
+        float end_y;
+        float cost;                 // Walking distance of the leg
+        int32_t action;             // Action at the end: 0 = none (goal), 1 = travel portal, 2 = NPC travel, 3 = Enter key
+        int32_t dialog_ids[5];      // Dialog IDs to send to the NPC (action 2, 0 otherwise)
+        int32_t dest_map_id;        // Map the action leads to (0 for the last leg)
+    };
+
+    // Structure for the world route result
+    struct WorldRouteResult {
+        WorldRouteLeg* legs;        // Array of legs, one per map walked
+        int32_t leg_count;          // Number of legs
+        float total_cost;           // Total walking distance
+        int32_t error_code;         // 0 = success, other = error
+        char error_message[256];    // Error message if applicable
+    };
+
     /**
      * @brief Finds a path between two points on a map, avoiding obstacle zones
      *
@@ -80,6 +130,99 @@ extern "C" {
      */
     PATHFINDER_API void FreePathResult(PathResult* result);
 
+    /**
+     * @brief Finds the paths of a batch of queries in one call
+     *
+     * Queries are grouped by map (each map is loaded once) and run in parallel on an
+     * internal work-stealing thread pool. Results are written to out_results[i] for queries[i],
+     * with the same error codes as FindPathWithObstacles. The points of all the results share
+     * a single allocation, which must be freed with FreePathsBatch.
+     *
+     * @param queries Array of queries
+     * @param count Number of queries
+     * @param out_results Array of count results, filled by the call
+     * @return int32_t Number of queries for which a path was found, -1 on invalid arguments or initialization failure
+     */
+    PATHFINDER_API int32_t FindPathsBatch(const PathQuery* queries, int32_t count, PathResult* out_results);
+
+    /**
+     * @brief Frees the points of the results filled by FindPathsBatch
+     *
+     * The results array itself belongs to the caller and is not freed. The shared block is
+     * found through the first result holding points, so results and count must be exactly
+     * those of the FindPathsBatch call: no sub-range, and no result freed with FreePathResult
+     * or with its points pointer changed in between.
+     *
+     * @param results Results passed to FindPathsBatch
+     * @param count Number of results passed to FindPathsBatch
+     */
+    PATHFINDER_API void FreePathsBatch(PathResult* results, int32_t count);
+
+    /**
+     * @brief Finds the walkable area (trapezoid) and layer of a batch of positions
+     *
+     * Much cheaper than a path query: the map is acquired once for the whole batch and
+     * each position is a single lookup in the map's trapezoid index. Positions outside
+     * every trapezoid get -1 as trapezoid ID and layer.
+     *
+     * @param map_id GW map ID (loaded from the archive if necessary)
+     * @param xy count (x, y) pairs: x0, y0, x1, y1, ...
+     * @param count Number of positions
+     * @param out_trapezoid_ids Array of count IDs, filled by the call
+     * @param out_layers Array of count layers, filled by the call
+     * @return int32_t Number of walkable positions, -1 on invalid arguments or initialization failure, -2 if the map could not be loaded
+     */
+    PATHFINDER_API int32_t LocatePoints(int32_t map_id, const float* xy, int32_t count,
+                                        int32_t* out_trapezoid_ids, int32_t* out_layers);
+
+    /**
+     * @brief Checks whether any path can join two positions of a map, without searching one
+     *
+     * Compares the connected components of the visibility graph points near the two positions.
+     * Obstacles are not taken into account: 0 means no path exists whatever the obstacles,
+     * 1 that a path exists when nothing blocks it.
+     *
+     * @param map_id GW map ID (loaded from the archive if necessary)
+     * @return int32_t 1 if reachable, 0 if not, -1 on initialization failure, -2 if the map could not be loaded
+     */
+    PATHFINDER_API int32_t IsReachable(int32_t map_id, float start_x, float start_y, float goal_x, float goal_y);
+
+    /**
+     * @brief Finds a route between two positions that may be on different maps
+     *
+     * Searches the transitions between maps (travel portals, NPC travel, Enter travel) for the
+     * shortest total walk. The walking costs between the transitions of a map are baked into
+     * maps.nav by GWMapBaker, so only the start and goal maps are loaded; maps missing from the
+     * pack can start or end a route but not be crossed. Each leg is a walk on one map, to be
+     * followed with FindPathWithObstacles, ended by the action that leads to the next map.
+     *
+     * Error codes: 1 = start or goal map not found or failed to load, 2 = no route,
+     * -1 = initialization failure, -2/-3 = exception.
+     *
+     * @param start_map_id Map of the start
+     * @param start_x Starting X coordinate
+     * @param start_y Starting Y coordinate
+     * @param goal_map_id Map of the goal (may be the start map)
+     * @param goal_x Goal X coordinate
+     * @param goal_y Goal Y coordinate
+     * @return WorldRouteResult* Pointer to the result (must be freed with FreeWorldRouteResult)
+     */
+    PATHFINDER_API WorldRouteResult* FindWorldRoute(
+        int32_t start_map_id,
+        float start_x,
+        float start_y,
+        int32_t goal_map_id,
+        float goal_x,
+        float goal_y
+    );
+
+    /**
+     * @brief Frees the memory allocated for a world route result
+     *
+     * @param result Pointer to the result to free
+     */
+    PATHFINDER_API void FreeWorldRouteResult(WorldRouteResult* result);
+
     /**
      * @brief Checks if a map is available in the DLL
      *
@@ -123,14 +266,127 @@ extern "C" {
     PATHFINDER_API void Shutdown();
 
     /**
-     * @brief Loads a map from an external JSON file
+     * @brief Loads a map from an external JSON file (or a single baked binary map)
      *
      * @param map_id ID of the map to load
-     * @param file_path Path to the JSON file
+     * @param file_path Path to the JSON or baked map file
      * @return int32_t 1 if success, 0 otherwise
      */
     PATHFINDER_API int32_t LoadMapFromFile(int32_t map_id, const char* file_path);
 
+    /**
+     * @brief Starts loading a map in the background
+     *
+     * Returns immediately. A query on the map issued before the load completes joins
+     * that load (running it itself if it has not started yet) instead of starting
+     * another one. Use GetMapLoadState to poll progress.
+     *
+     * @param map_id ID of the map to load
+     * @return int32_t 1 if the map is loaded, loading or queued, 0 otherwise
+     */
+    PATHFINDER_API int32_t PrefetchMap(int32_t map_id);
+
+    /**
+     * @brief Starts loading several maps in the background (see PrefetchMap)
+     *
+     * @param map_ids Array of map IDs
+     * @param count Number of IDs in the array
+     * @return int32_t Number of maps that are loaded, loading or queued
+     */
+    PATHFINDER_API int32_t PrefetchMaps(const int32_t* map_ids, int32_t count);
+
+    /**
+     * @brief Gets the load state of a map
+     *
+     * @param map_id ID of the map
+     * @return int32_t 0 = not loaded, 1 = loading, 2 = loaded, 3 = not found, 4 = load failed, -1 = not initialized
+     */
+    PATHFINDER_API int32_t GetMapLoadState(int32_t map_id);
+
+    /**
+     * @brief Configures the background loading of neighbour maps
+     *
+     * When enabled, each time a query switches to another map, the maps linked to it
+     * (travel portals, NPC and enter travel) are queued for background loading, after
+     * any PrefetchMap request. Warming never evicts a map: it stops once the cache holds
+     * byte_budget bytes (or its own budget, whichever is lower). Disabled by default.
+     *
+     * @param enabled 1 to enable, 0 to disable
+     * @param max_fan_out Maximum number of linked maps queued per map switch
+     * @param byte_budget Cache occupancy in bytes above which no map is warmed
+     */
+    PATHFINDER_API void SetMapWarming(int32_t enabled, int32_t max_fan_out, uint64_t byte_budget);
+
+    /**
+     * @brief Builds a contraction hierarchy for the maps loaded without one
+     *
+     * Queries without obstacles on a map that has a contraction hierarchy run a
+     * bidirectional search over it instead of A*. Hierarchies are normally baked into
+     * maps.nav (GWMapBaker --ch); building one at load takes up to a few seconds on the
+     * largest maps, so this is best combined with PrefetchMap. Only maps loaded afterwards
+     * are affected. Disabled by default.
+     *
+     * @param enabled 1 to enable, 0 to disable
+     */
+    PATHFINDER_API void SetBuildContractionHierarchies(int32_t enabled);
+
+    /**
+     * @brief Builds the cluster level of the maps loaded afterwards (hierarchical search)
+     *
+     * The map is cut into square clusters of a few hundred points, and the shortest paths
+     * between the border points of each cluster are precomputed. Queries that cannot use a
+     * contraction hierarchy (obstacles, or no hierarchy on the map) then cross the clusters
+     * away from the start, the goal and the obstacles in one step each. Paths and costs are
+     * the same as without it. Building takes up to ~100 ms per map and adds about the memory
+     * of the map itself. Disabled by default.
+     *
+     * @param enabled 1 to enable, 0 to disable
+     */
+    PATHFINDER_API void SetBuildHierarchicalGraphs(int32_t enabled);
+
+    /**
+     * @brief Makes obstacles also block the graph edges that cross them
+     *
+     * By default an obstacle only removes the graph points inside it, so a long straight
+     * edge between two points outside the circle can still pass through it. When enabled,
+     * FindPathWithObstacles and FindPathsBatch also reject every edge whose segment touches
+     * an obstacle. Off by default.
+     *
+     * @param enabled 1 to test edges, 0 to only test points
+     */
+    PATHFINDER_API void SetObstacleEdgeTest(int32_t enabled);
+
+    /**
+     * @brief Selects the open set used by the searches
+     *
+     * The indexed 4-ary heap keeps one entry per node and lowers its priority in place; the
+     * binary heap pushes a new entry on every improvement and pops the outdated ones later.
+     * Paths are the same with both, the indexed heap is 10 to 25% faster on the shipped maps.
+     * On by default; the binary heap is kept for comparison.
+     *
+     * @param enabled 1 for the indexed 4-ary heap, 0 for the binary heap
+     */
+    PATHFINDER_API void SetIndexedOpenSet(int32_t enabled);
+
+    /**
+     * @brief Lets long searches run from both ends
+     *
+     * When enabled, FindPathWithObstacles and FindPathsBatch search from the start and from the
+     * goal at once (NBA*) when the two are at least min_distance apart, on maps whose graph is
+     * symmetric (every map without one-way teleporters); paths have the same cost as with the
+     * forward search. With obstacles it expands about 18% fewer nodes on the shipped maps, for
+     * about the same time (two frontiers cost more per node); without them it expands no fewer,
+     * and such queries mostly use the contraction hierarchy anyway. With parallel, the backward
+     * search runs on the batch worker pool; queries are too short for that to pay on the shipped
+     * maps. A failure of the backward search on the pool is reported as an error of the query
+     * (error_code -2), not as a missing path. Off by default.
+     *
+     * @param enabled 1 to search long queries from both ends, 0 to always search forward
+     * @param min_distance Straight-line distance from which a query is searched from both ends
+     * @param parallel 1 to run the backward search on another thread
+     */
+    PATHFINDER_API void SetBidirectionalSearch(int32_t enabled, float min_distance, int32_t parallel);
+
     /**
      * @brief Gets the statistics of a map
      *
@@ -146,4 +402,51 @@ extern "C" {
      */
     PATHFINDER_API void FreeMapStats(MapStats* stats);
 
+    /**
+     * @brief Gets the statistics of the loaded map cache
+     *
+     * @return MapCacheStats* Pointer to the stats (must be freed with FreeMapCacheStats)
+     */
+    PATHFINDER_API MapCacheStats* GetMapCacheStats();
+
+    /**
+     * @brief Frees the memory allocated for the cache statistics
+     *
+     * @param stats Pointer to the stats to free
+     */
+    PATHFINDER_API void FreeMapCacheStats(MapCacheStats* stats);
+
+    /**
+     * @brief Resets the hit/miss/eviction counters of the map cache
+     */
+    PATHFINDER_API void ResetMapCacheStats();
+
+    /**
+     * @brief Sets the memory budget of the loaded map cache
+     *
+     * Least recently used maps are evicted (immediately if needed) to stay within
+     * the budget. Pinned maps are never evicted.
+     *
+     * @param byte_budget Budget in bytes (default 64 MB)
+     */
+    PATHFINDER_API void SetMapCacheBudget(uint64_t byte_budget);
+
+    /**
+     * @brief Pins a map in memory, loading it if necessary
+     *
+     * Pins are counted: each PinMap must be matched by an UnpinMap.
+     *
+     * @param map_id ID of the map (e.g. the map the bot is currently on)
+     * @return int32_t 1 if the map is loaded and pinned, 0 otherwise
+     */
+    PATHFINDER_API int32_t PinMap(int32_t map_id);
+
+    /**
+     * @brief Releases a pin taken with PinMap
+     *
+     * @param map_id ID of the map
+     * @return int32_t 1 if a pin was released, 0 if the map was not pinned
+     */
+    PATHFINDER_API int32_t UnpinMap(int32_t map_id);
+
 }
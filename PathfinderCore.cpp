@@ -1,231 +1,961 @@
 #include "PathfinderCore.h"
-#include <queue>
+#include "BinaryMapFormat.h"
+#include "MapJsonParser.h"
+#include "SearchKernel.h"
+#include <functional>
 #include <algorithm>
 #include <limits>
 #include <sstream>
 #include <unordered_set>
 
-// Simple JSON parser (minimal, just for our format)
-#include <nlohmann/json.hpp>
-
-using json = nlohmann::json;
+// Width of the obstacle segment test and of the trapezoid box filter: AVX2 when the build targets it (GWPATHFINDER_AVX2),
+// otherwise SSE2, which every x86 target of the DLL has; scalar elsewhere
+#if defined(__AVX2__)
+#define PATHFINDER_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PATHFINDER_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace Pathfinder {
 
+    namespace {
+        // Obstacle arrays are padded to the widest vector of the segment test
+        const size_t kObstacleLanes = 8;
+        const float kPaddingCoordinate = 1e30f;
+
+        // Trapezoid boxes tested per step of the point location
+        const uint32_t kTrapezoidLanes = 8;
+    }
+
+    PathfinderEngine::PathfinderEngine()
+        : m_warming_enabled(false)
+        , m_warming_fan_out(MapWarmingOptions().max_fan_out)
+        , m_warming_byte_budget(MapWarmingOptions().byte_budget)
+        , m_active_map_id(-1)
+        , m_build_contraction_hierarchies(false)
+        , m_build_hierarchical_graphs(false)
+        , m_obstacle_edge_test(false)
+        , m_indexed_open_set(true)
+        , m_bidirectional_enabled(BidirectionalSearchOptions().enabled)
+        , m_bidirectional_min_distance(BidirectionalSearchOptions().min_distance)
+        , m_bidirectional_parallel(BidirectionalSearchOptions().parallel) {
+    }
+
+    bool PathfinderEngine::BuildMapFromJson(int32_t map_id, const std::string& json_data, MapData& out_map_data) {
+        if (!ParseMapJson(json_data, out_map_data)) {
+            return false;
+        }
+
+        out_map_data.map_id = map_id;
+        return true;
+    }
+
+    bool PathfinderEngine::BuildMapFromBinary(int32_t map_id, const uint8_t* data, size_t size, MapData& out_map_data) {
+        if (!ReadBinaryMap(data, size, out_map_data)) {
+            return false;
+        }
+
+        // Sections are copied as-is, only the lookup structures are rebuilt
+        out_map_data.map_id = map_id;
+        out_map_data.BuildSpatialIndex();
+        return out_map_data.IsValid();
+    }
+
     bool PathfinderEngine::LoadMapData(int32_t map_id, const std::string& json_data) {
         MapData map_data;
-        if (!ParseMapJson(json_data, map_data)) {
+        if (!BuildMapFromJson(map_id, json_data, map_data)) {
             return false;
         }
 
-        map_data.map_id = map_id;
-        m_loaded_maps[map_id] = std::move(map_data);
+        PrepareLoadedMap(map_data);
+        m_map_cache.Put(map_id, std::make_shared<const MapData>(std::move(map_data)));
         return true;
     }
 
-    bool PathfinderEngine::ParseMapJson(const std::string& json_data, MapData& out_map_data) {
-        try {
-            auto j = json::parse(json_data);
+    bool PathfinderEngine::LoadMapDataBinary(int32_t map_id, const uint8_t* data, size_t size) {
+        MapData map_data;
+        if (!BuildMapFromBinary(map_id, data, size, map_data)) {
+            return false;
+        }
+
+        PrepareLoadedMap(map_data);
+        m_map_cache.Put(map_id, std::make_shared<const MapData>(std::move(map_data)));
+        return true;
+    }
+
+    void PathfinderEngine::SetMapSource(MapSource source) {
+        m_map_source = std::move(source);
+    }
 
-            // Parse map IDs (may contain multiple IDs)
-            if (j.contains("map_ids") && j["map_ids"].is_array()) {
-                // Take the first ID from the list
-                if (!j["map_ids"].empty()) {
-                    out_map_data.map_id = j["map_ids"][0].get<int32_t>();
+    std::shared_ptr<const MapData> PathfinderEngine::AcquireMap(int32_t map_id, MapLoadStatus* out_status) {
+        if (out_status) {
+            *out_status = MapLoadStatus::Loaded;
+        }
+
+        std::shared_ptr<const MapData> map_data = m_map_cache.Get(map_id);
+        if (!map_data) {
+            // Join the load in flight for this map (a prefetch or another query), or perform it
+            std::shared_ptr<PendingLoad> pending;
+            {
+                std::lock_guard<std::mutex> lock(m_load_mutex);
+                auto it = m_pending_loads.find(map_id);
+                if (it != m_pending_loads.end()) {
+                    pending = it->second;
+                }
+                else {
+                    // The previous load may have been published just before we took the lock
+                    map_data = m_map_cache.Find(map_id);
+                    if (!map_data) {
+                        pending = RegisterLoadUnlocked(map_id);
+                    }
                 }
             }
 
-            // Parse points
-            if (j.contains("points") && j["points"].is_array()) {
-                for (const auto& p : j["points"]) {
-                    if (p.is_array() && p.size() >= 3) {
-                        int32_t id = p[0].get<int32_t>();
-                        float x = p[1].get<float>();
-                        float y = p[2].get<float>();
-                        int32_t layer = (p.size() >= 4) ? p[3].get<int32_t>() : 0;
-                        out_map_data.points.emplace_back(id, x, y, layer);
-                    }
+            if (pending) {
+                // A load still waiting in a background queue is run here rather than waited for
+                RunPendingLoad(map_id, pending);
+
+                const MapLoadResult& result = pending->result.get();
+                if (out_status) {
+                    *out_status = result.status;
                 }
+                map_data = result.map;
             }
+        }
+
+        if (map_data && m_warming_enabled.load(std::memory_order_relaxed)
+            && m_active_map_id.exchange(map_id, std::memory_order_relaxed) != map_id) {
+            WarmLinkedMaps(*map_data);
+        }
+        return map_data;
+    }
 
-            // Parse visibility graph
-            if (j.contains("vis_graph") && j["vis_graph"].is_array()) {
-                out_map_data.visibility_graph.resize(j["vis_graph"].size());
+    bool PathfinderEngine::BeginLoad(int32_t map_id) {
+        std::lock_guard<std::mutex> lock(m_load_mutex);
+        if (m_pending_loads.find(map_id) != m_pending_loads.end() || m_map_cache.Contains(map_id)) {
+            return false;
+        }
 
-                for (size_t i = 0; i < j["vis_graph"].size(); ++i) {
-                    const auto& edges = j["vis_graph"][i];
-                    if (!edges.is_array()) continue;
+        RegisterLoadUnlocked(map_id);
+        return true;
+    }
 
-                    for (const auto& edge : edges) {
-                        if (edge.is_array() && edge.size() >= 2) {
-                            int32_t target_id = edge[0].get<int32_t>();
-                            float distance = edge[1].get<float>();
+    void PathfinderEngine::RunLoad(int32_t map_id) {
+        std::shared_ptr<PendingLoad> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_load_mutex);
+            auto it = m_pending_loads.find(map_id);
+            if (it == m_pending_loads.end()) {
+                return;
+            }
+            pending = it->second;
+        }
 
-                            std::vector<uint32_t> blocking_layers;
-                            if (edge.size() >= 3 && edge[2].is_array()) {
-                                for (const auto& layer : edge[2]) {
-                                    blocking_layers.push_back(layer.get<uint32_t>());
-                                }
-                            }
+        RunPendingLoad(map_id, pending);
+    }
 
-                            out_map_data.visibility_graph[i].emplace_back(
-                                target_id, distance, blocking_layers
-                            );
-                        }
-                    }
-                }
+    void PathfinderEngine::RunPendingLoad(int32_t map_id, const std::shared_ptr<PendingLoad>& pending) {
+        if (pending->started.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+
+        MapLoadResult result = LoadFromSource(map_id);
+        if (result.map) {
+            try {
+                m_map_cache.Put(map_id, result.map);
             }
+            catch (...) {
+                // Still handed to the waiting callers, only not cached
+            }
+        }
 
-            // Parse trapezoids
-            // Format: [id, layer, ax, ay, bx, by, cx, cy, dx, dy]
-            if (j.contains("trapezoids") && j["trapezoids"].is_array()) {
-                for (const auto& trap : j["trapezoids"]) {
-                    if (trap.is_array() && trap.size() >= 10) {
-                        int32_t id = trap[0].get<int32_t>();
-                        int32_t layer = trap[1].get<int32_t>();
-                        float ax = trap[2].get<float>();
-                        float ay = trap[3].get<float>();
-                        float bx = trap[4].get<float>();
-                        float by = trap[5].get<float>();
-                        float cx = trap[6].get<float>();
-                        float cy = trap[7].get<float>();
-                        float dx = trap[8].get<float>();
-                        float dy = trap[9].get<float>();
-
-                        out_map_data.trapezoids.emplace_back(
-                            id, layer, ax, ay, bx, by, cx, cy, dx, dy
-                        );
-                    }
-                }
+        // Published before the pending entry goes away, so no caller can miss both
+        {
+            std::lock_guard<std::mutex> lock(m_load_mutex);
+            m_pending_loads.erase(map_id);
+            if (result.map) {
+                m_failed_loads.erase(map_id);
             }
+            else {
+                m_failed_loads[map_id] = result.status;
+            }
+        }
+        pending->promise.set_value(result);
+    }
 
-            // Parse teleporters
-            if (j.contains("teleports") && j["teleports"].is_array()) {
-                for (const auto& tp : j["teleports"]) {
-                    if (tp.is_array() && tp.size() >= 6) {
-                        float enter_x = tp[0].get<float>();
-                        float enter_y = tp[1].get<float>();
-                        int32_t enter_layer = tp[2].get<int32_t>();
-                        float exit_x = tp[3].get<float>();
-                        float exit_y = tp[4].get<float>();
-                        int32_t exit_layer = tp[5].get<int32_t>();
-                        int32_t direction = (tp.size() >= 7) ? tp[6].get<int32_t>() : 0;
-
-                        out_map_data.teleporters.emplace_back(
-                            enter_x, enter_y, exit_x, exit_y, direction
-                        );
-                    }
-                }
+    MapLoadState PathfinderEngine::GetMapLoadState(int32_t map_id) const {
+        std::lock_guard<std::mutex> lock(m_load_mutex);
+        if (m_pending_loads.find(map_id) != m_pending_loads.end()) {
+            return MapLoadState::Loading;
+        }
+
+        if (m_map_cache.Contains(map_id)) {
+            return MapLoadState::Loaded;
+        }
+
+        auto it = m_failed_loads.find(map_id);
+        if (it != m_failed_loads.end()) {
+            return it->second == MapLoadStatus::NotFound ? MapLoadState::NotFound : MapLoadState::Failed;
+        }
+        return MapLoadState::NotLoaded;
+    }
+
+    void PathfinderEngine::WaitForLoads() {
+        std::vector<std::shared_ptr<PendingLoad>> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_load_mutex);
+            pending.reserve(m_pending_loads.size());
+            for (const auto& pair : m_pending_loads) {
+                pending.push_back(pair.second);
             }
+        }
 
-            // Parse travel portals
-            // Format: [x, y, [[map_id, dest_x, dest_y], ...]]
-            if (j.contains("travel_portals") && j["travel_portals"].is_array()) {
-                for (const auto& portal : j["travel_portals"]) {
-                    if (portal.is_array() && portal.size() >= 2) {
-                        float portal_x = portal[0].get<float>();
-                        float portal_y = portal[1].get<float>();
+        for (const auto& load : pending) {
+            load->result.wait();
+        }
+    }
 
-                        TravelPortal tp(portal_x, portal_y);
+    void PathfinderEngine::SetBackgroundScheduler(TaskScheduler scheduler) {
+        m_background_scheduler = std::move(scheduler);
+    }
 
-                        // Parse connections if present
-                        if (portal.size() >= 3 && portal[2].is_array()) {
-                            for (const auto& conn : portal[2]) {
-                                if (conn.is_array() && conn.size() >= 3) {
-                                    int32_t map_id = conn[0].get<int32_t>();
-                                    float dest_x = conn[1].get<float>();
-                                    float dest_y = conn[2].get<float>();
+    void PathfinderEngine::SetSearchScheduler(TaskScheduler scheduler) {
+        m_search_scheduler = std::move(scheduler);
+    }
 
-                                    tp.connections.emplace_back(map_id, dest_x, dest_y);
-                                }
-                            }
-                        }
+    void PathfinderEngine::SetMapWarming(const MapWarmingOptions& options) {
+        m_warming_fan_out.store(std::max(options.max_fan_out, 0), std::memory_order_relaxed);
+        m_warming_byte_budget.store(options.byte_budget, std::memory_order_relaxed);
+        m_warming_enabled.store(options.enabled, std::memory_order_relaxed);
 
-                        out_map_data.travel_portals.push_back(std::move(tp));
-                    }
-                }
+        // The next query counts as an activation
+        m_active_map_id.store(-1, std::memory_order_relaxed);
+    }
+
+    MapWarmingOptions PathfinderEngine::GetMapWarming() const {
+        MapWarmingOptions options;
+        options.enabled = m_warming_enabled.load(std::memory_order_relaxed);
+        options.max_fan_out = m_warming_fan_out.load(std::memory_order_relaxed);
+        options.byte_budget = m_warming_byte_budget.load(std::memory_order_relaxed);
+        return options;
+    }
+
+    std::vector<int32_t> PathfinderEngine::GetLinkedMapIds(const MapData& map_data) {
+        std::vector<int32_t> ids;
+        auto add = [&ids, &map_data](int32_t dest_map_id) {
+            if (dest_map_id > 0 && dest_map_id != map_data.map_id
+                && std::find(ids.begin(), ids.end(), dest_map_id) == ids.end()) {
+                ids.push_back(dest_map_id);
             }
+        };
 
-            // Parse NPC Travel
-            // Format: [npcX, npcY, dialogid1, dialogid2, dialogid3, dialogid4, dialogid5, mapid, posX, posY]
-            if (j.contains("npc_travel") && j["npc_travel"].is_array()) {
-                for (const auto& npc : j["npc_travel"]) {
-                    if (npc.is_array() && npc.size() >= 10) {
-                        float npc_x = npc[0].get<float>();
-                        float npc_y = npc[1].get<float>();
-                        int32_t d1 = npc[2].get<int32_t>();
-                        int32_t d2 = npc[3].get<int32_t>();
-                        int32_t d3 = npc[4].get<int32_t>();
-                        int32_t d4 = npc[5].get<int32_t>();
-                        int32_t d5 = npc[6].get<int32_t>();
-                        int32_t map_id = npc[7].get<int32_t>();
-                        float dest_x = npc[8].get<float>();
-                        float dest_y = npc[9].get<float>();
-
-                        out_map_data.npc_travels.emplace_back(
-                            npc_x, npc_y, d1, d2, d3, d4, d5, map_id, dest_x, dest_y
-                        );
-                    }
+        for (const auto& portal : map_data.travel_portals) {
+            for (const auto& connection : portal.connections) {
+                add(connection.dest_map_id);
+            }
+        }
+        for (const auto& npc : map_data.npc_travels) {
+            add(npc.dest_map_id);
+        }
+        for (const auto& enter : map_data.enter_travels) {
+            add(enter.dest_map_id);
+        }
+        return ids;
+    }
+
+    void PathfinderEngine::WarmLinkedMaps(const MapData& map_data) {
+        if (!m_background_scheduler) {
+            return;
+        }
+
+        // Queued loads keep the engine alive; an engine not owned by a shared_ptr is not warmed
+        std::shared_ptr<PathfinderEngine> self = weak_from_this().lock();
+        if (!self) {
+            return;
+        }
+
+        const int32_t max_fan_out = m_warming_fan_out.load(std::memory_order_relaxed);
+        const MapCacheStatistics stats = m_map_cache.GetStatistics();
+        const uint64_t budget = std::min(m_warming_byte_budget.load(std::memory_order_relaxed), stats.byte_budget);
+
+        // Linked maps are assumed to be about the size of the active one; warming never evicts
+        const uint64_t estimate = map_data.MemoryUsage();
+        uint64_t projected = stats.bytes_used;
+
+        int32_t queued = 0;
+        for (int32_t linked_map_id : GetLinkedMapIds(map_data)) {
+            if (queued >= max_fan_out || projected + estimate > budget) {
+                break;
+            }
+
+            // Already loaded, loading, or known to be missing
+            if (GetMapLoadState(linked_map_id) != MapLoadState::NotLoaded || !BeginLoad(linked_map_id)) {
+                continue;
+            }
+
+            try {
+                m_background_scheduler([self, linked_map_id]() {
+                    self->RunLoad(linked_map_id);
+                });
+            }
+            catch (...) {
+                // A registered load must always run, or the queries waiting on it would hang
+                RunLoad(linked_map_id);
+            }
+
+            projected += estimate;
+            queued++;
+        }
+    }
+
+    std::shared_ptr<PathfinderEngine::PendingLoad> PathfinderEngine::RegisterLoadUnlocked(int32_t map_id) {
+        auto pending = std::make_shared<PendingLoad>();
+        pending->result = pending->promise.get_future().share();
+        m_pending_loads.emplace(map_id, pending);
+        return pending;
+    }
+
+    PathfinderEngine::MapLoadResult PathfinderEngine::LoadFromSource(int32_t map_id) {
+        MapLoadResult result;
+        result.status = MapLoadStatus::NotFound;
+        if (!m_map_source) {
+            return result;
+        }
+
+        try {
+            auto map_data = std::make_shared<MapData>();
+            result.status = m_map_source(map_id, *map_data);
+            if (result.status == MapLoadStatus::Loaded) {
+                PrepareLoadedMap(*map_data);
+                result.map = std::move(map_data);
+            }
+        }
+        catch (...) {
+            result.status = MapLoadStatus::Failed;
+        }
+        return result;
+    }
+
+    void PathfinderEngine::PrepareLoadedMap(MapData& map_data) const {
+        if (map_data.landmarks.Empty()) {
+            map_data.BuildLandmarks();
+        }
+        if (m_build_contraction_hierarchies.load(std::memory_order_relaxed) && map_data.contraction_hierarchy.Empty()) {
+            map_data.BuildContractionHierarchy();
+        }
+        if (m_build_hierarchical_graphs.load(std::memory_order_relaxed) && map_data.hierarchical_graph.Empty()) {
+            map_data.BuildHierarchicalGraph();
+        }
+    }
+
+    void PathfinderEngine::SetBuildContractionHierarchies(bool enabled) {
+        m_build_contraction_hierarchies.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool PathfinderEngine::GetBuildContractionHierarchies() const {
+        return m_build_contraction_hierarchies.load(std::memory_order_relaxed);
+    }
+
+    void PathfinderEngine::SetBuildHierarchicalGraphs(bool enabled) {
+        m_build_hierarchical_graphs.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool PathfinderEngine::GetBuildHierarchicalGraphs() const {
+        return m_build_hierarchical_graphs.load(std::memory_order_relaxed);
+    }
+
+    void PathfinderEngine::SetObstacleEdgeTest(bool enabled) {
+        m_obstacle_edge_test.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool PathfinderEngine::GetObstacleEdgeTest() const {
+        return m_obstacle_edge_test.load(std::memory_order_relaxed);
+    }
+
+    void PathfinderEngine::SetIndexedOpenSet(bool enabled) {
+        m_indexed_open_set.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool PathfinderEngine::GetIndexedOpenSet() const {
+        return m_indexed_open_set.load(std::memory_order_relaxed);
+    }
+
+    void PathfinderEngine::SetBidirectionalSearch(const BidirectionalSearchOptions& options) {
+        m_bidirectional_min_distance.store(std::max(options.min_distance, 0.0f), std::memory_order_relaxed);
+        m_bidirectional_parallel.store(options.parallel, std::memory_order_relaxed);
+        m_bidirectional_enabled.store(options.enabled, std::memory_order_relaxed);
+    }
+
+    BidirectionalSearchOptions PathfinderEngine::GetBidirectionalSearch() const {
+        BidirectionalSearchOptions options;
+        options.enabled = m_bidirectional_enabled.load(std::memory_order_relaxed);
+        options.min_distance = m_bidirectional_min_distance.load(std::memory_order_relaxed);
+        options.parallel = m_bidirectional_parallel.load(std::memory_order_relaxed);
+        return options;
+    }
+
+    bool PathfinderEngine::UnloadMap(int32_t map_id) {
+        return m_map_cache.Remove(map_id);
+    }
+
+    std::shared_ptr<const MapData> PathfinderEngine::GetMapData(int32_t map_id) {
+        return m_map_cache.Get(map_id);
+    }
+
+    bool PathfinderEngine::ParseMapJson(const std::string& json_data, MapData& out_map_data) {
+        // Streaming parse straight into MapData, no JSON document is built
+        if (!ParseMapJsonStreaming(json_data, out_map_data)) {
+            return false;
+        }
+
+        // Build the lookup structures once, queries only read them
+        out_map_data.BuildSpatialIndex();
+
+        return out_map_data.IsValid();
+    }
+
+    namespace {
+        template <typename T>
+        size_t VectorBytes(const std::vector<T>& values) {
+            return values.capacity() * sizeof(T);
+        }
+
+        size_t GridBytes(const UniformGrid& grid) {
+            return VectorBytes(grid.cell_offsets) + VectorBytes(grid.items);
+        }
+    }
+
+    size_t MapData::MemoryUsage() const {
+        size_t bytes = sizeof(MapData);
+        bytes += VectorBytes(points);
+        bytes += VectorBytes(visibility_graph.offsets) + VectorBytes(visibility_graph.targets) +
+                 VectorBytes(visibility_graph.distances) + VectorBytes(visibility_graph.blocking_edges) +
+                 VectorBytes(visibility_graph.blocking_offsets) + VectorBytes(visibility_graph.blocking_layers);
+        bytes += VectorBytes(trapezoids);
+        bytes += VectorBytes(teleporters);
+        bytes += VectorBytes(travel_portals);
+        for (const auto& portal : travel_portals) {
+            bytes += VectorBytes(portal.connections);
+        }
+        bytes += VectorBytes(npc_travels);
+        bytes += VectorBytes(enter_travels);
+        bytes += GridBytes(trapezoid_index.grid);
+        bytes += VectorBytes(trapezoid_index.box_min_x) + VectorBytes(trapezoid_index.box_min_y) +
+                 VectorBytes(trapezoid_index.box_max_x) + VectorBytes(trapezoid_index.box_max_y);
+        bytes += GridBytes(point_index.grid);
+        bytes += VectorBytes(teleporter_entry_distances);
+        bytes += VectorBytes(max_edge_lengths);
+        bytes += contraction_hierarchy.MemoryUsage();
+        bytes += landmarks.MemoryUsage();
+        bytes += hierarchical_graph.MemoryUsage();
+        bytes += components.MemoryUsage();
+        bytes += VectorBytes(travel_costs.arrivals) + VectorBytes(travel_costs.costs);
+        return bytes;
+    }
+
+    void MapData::BuildContractionHierarchy() {
+        const VisibilityGraph& graph = visibility_graph;
+        if (graph.NodeCount() != static_cast<int32_t>(points.size())) {
+            contraction_hierarchy.Clear();
+            return;
+        }
+
+        contraction_hierarchy.Build(graph.NodeCount(), graph.offsets.data(), graph.targets.data(), graph.distances.data());
+    }
+
+    void MapData::BuildLandmarks() {
+        const VisibilityGraph& graph = visibility_graph;
+        if (graph.NodeCount() != static_cast<int32_t>(points.size())) {
+            landmarks.Clear();
+            return;
+        }
+
+        landmarks.Build(graph.NodeCount(), graph.offsets.data(), graph.targets.data(), graph.distances.data());
+    }
+
+    void MapData::BuildHierarchicalGraph() {
+        const VisibilityGraph& graph = visibility_graph;
+        if (graph.NodeCount() != static_cast<int32_t>(points.size())) {
+            hierarchical_graph.Clear();
+            return;
+        }
+
+        std::vector<float> xs;
+        std::vector<float> ys;
+        xs.reserve(points.size());
+        ys.reserve(points.size());
+        for (const auto& point : points) {
+            xs.push_back(point.pos.x);
+            ys.push_back(point.pos.y);
+        }
+        hierarchical_graph.Build(graph.NodeCount(), graph.offsets.data(), graph.targets.data(), graph.distances.data(),
+                                 xs.data(), ys.data());
+    }
+
+    std::vector<MapTransition> MapData::GetTransitions() const {
+        std::vector<MapTransition> transitions;
+        for (const auto& portal : travel_portals) {
+            for (const auto& connection : portal.connections) {
+                if (connection.dest_map_id > 0) {
+                    MapTransition transition;
+                    transition.kind = TravelKind::Portal;
+                    transition.position = portal.position;
+                    transition.dest_map_id = connection.dest_map_id;
+                    transition.dest_pos = connection.dest_pos;
+                    transitions.push_back(transition);
                 }
             }
+        }
+        for (const auto& npc : npc_travels) {
+            if (npc.dest_map_id > 0) {
+                MapTransition transition;
+                transition.kind = TravelKind::Npc;
+                transition.position = npc.npc_pos;
+                transition.dest_map_id = npc.dest_map_id;
+                transition.dest_pos = npc.dest_pos;
+                std::copy(npc.dialog_ids, npc.dialog_ids + 5, transition.dialog_ids);
+                transitions.push_back(transition);
+            }
+        }
+        for (const auto& enter : enter_travels) {
+            if (enter.dest_map_id > 0) {
+                MapTransition transition;
+                transition.kind = TravelKind::Enter;
+                transition.position = enter.enter_pos;
+                transition.dest_map_id = enter.dest_map_id;
+                transition.dest_pos = enter.dest_pos;
+                transitions.push_back(transition);
+            }
+        }
+        return transitions;
+    }
 
-            // Parse Enter Travel
-            // Format: [enterX, enterY, mapid, destX, destY]
-            if (j.contains("enter_travel") && j["enter_travel"].is_array()) {
-                for (const auto& enter : j["enter_travel"]) {
-                    if (enter.is_array() && enter.size() >= 5) {
-                        float enter_x = enter[0].get<float>();
-                        float enter_y = enter[1].get<float>();
-                        int32_t map_id = enter[2].get<int32_t>();
-                        float dest_x = enter[3].get<float>();
-                        float dest_y = enter[4].get<float>();
-
-                        out_map_data.enter_travels.emplace_back(
-                            enter_x, enter_y, map_id, dest_x, dest_y
-                        );
-                    }
+    bool VisibilityGraph::IsSymmetric() const {
+        // Rows hold a few dozen edges at most: the reverse of each edge is found by scanning its target's row
+        for (int32_t node = 0; node < NodeCount(); ++node) {
+            for (uint32_t e = offsets[node]; e < offsets[node + 1]; ++e) {
+                const int32_t target = targets[e];
+                bool reversed = false;
+                for (uint32_t r = offsets[target]; r < offsets[target + 1] && !reversed; ++r) {
+                    reversed = targets[r] == node && distances[r] == distances[e];
                 }
+                if (!reversed) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void VisibilityGraph::MaxEdgeLengths(std::vector<float>& out_lengths) const {
+        out_lengths.assign(NodeCount(), 0.0f);
+        for (int32_t node = 0; node < NodeCount(); ++node) {
+            for (uint32_t e = offsets[node]; e < offsets[node + 1]; ++e) {
+                out_lengths[node] = std::max(out_lengths[node], distances[e]);
             }
+        }
+    }
+
+    int32_t MapData::LocatePoints(const float* xy, int32_t count, int32_t* out_trapezoid_ids, int32_t* out_layers) const {
+        int32_t walkable = 0;
+        for (int32_t i = 0; i < count; ++i) {
+            const Vec2f pos(xy[2 * i], xy[2 * i + 1]);
+            const Trapezoid* trap = std::isfinite(pos.x) && std::isfinite(pos.y) ? FindTrapezoidContaining(pos) : nullptr;
+            out_trapezoid_ids[i] = trap ? trap->id : -1;
+            out_layers[i] = trap ? trap->layer : -1;
+            walkable += trap ? 1 : 0;
+        }
+        return walkable;
+    }
+
+    void UniformGrid::Build(const std::vector<Vec2f>& box_min, const std::vector<Vec2f>& box_max, float target_cell_size) {
+        cell_offsets.clear();
+        items.clear();
+
+        if (box_min.empty() || box_min.size() != box_max.size() || target_cell_size <= 0.0f) {
+            return;
+        }
+
+        Vec2f lo = box_min[0];
+        Vec2f hi = box_max[0];
+        for (size_t i = 1; i < box_min.size(); ++i) {
+            lo.x = std::min(lo.x, box_min[i].x);
+            lo.y = std::min(lo.y, box_min[i].y);
+            hi.x = std::max(hi.x, box_max[i].x);
+            hi.y = std::max(hi.y, box_max[i].y);
+        }
+
+        origin = lo;
+        cell_size = target_cell_size;
+        inv_cell_size = 1.0f / cell_size;
+        cols = std::max(1, static_cast<int32_t>(std::ceil((hi.x - lo.x) * inv_cell_size)));
+        rows = std::max(1, static_cast<int32_t>(std::ceil((hi.y - lo.y) * inv_cell_size)));
 
-            // Parse stats
-            if (j.contains("stats") && j["stats"].is_object()) {
-                const auto& stats = j["stats"];
-                if (stats.contains("trapezoid_count")) {
-                    out_map_data.stats.trapezoid_count = stats["trapezoid_count"].get<int32_t>();
+        // Count the items of each cell, then fill the buckets in item order
+        const size_t cell_count = static_cast<size_t>(cols) * static_cast<size_t>(rows);
+        cell_offsets.assign(cell_count + 1, 0);
+
+        for (size_t i = 0; i < box_min.size(); ++i) {
+            for (int32_t cy = CellY(box_min[i].y); cy <= CellY(box_max[i].y); ++cy) {
+                for (int32_t cx = CellX(box_min[i].x); cx <= CellX(box_max[i].x); ++cx) {
+                    cell_offsets[CellIndex(cx, cy) + 1]++;
                 }
-                if (stats.contains("point_count")) {
-                    out_map_data.stats.point_count = stats["point_count"].get<int32_t>();
+            }
+        }
+
+        for (size_t c = 0; c < cell_count; ++c) {
+            cell_offsets[c + 1] += cell_offsets[c];
+        }
+
+        items.resize(cell_offsets[cell_count]);
+        std::vector<uint32_t> cursor(cell_offsets.begin(), cell_offsets.end() - 1);
+
+        for (size_t i = 0; i < box_min.size(); ++i) {
+            for (int32_t cy = CellY(box_min[i].y); cy <= CellY(box_max[i].y); ++cy) {
+                for (int32_t cx = CellX(box_min[i].x); cx <= CellX(box_max[i].x); ++cx) {
+                    items[cursor[CellIndex(cx, cy)]++] = static_cast<int32_t>(i);
                 }
-                if (stats.contains("teleport_count")) {
-                    out_map_data.stats.teleport_count = stats["teleport_count"].get<int32_t>();
+            }
+        }
+    }
+
+    namespace {
+        // Bit i is set when the bounding box of slot + i of the index contains pos
+#if defined(PATHFINDER_AVX2)
+        uint32_t TrapezoidBoxMask(const TrapezoidIndex& index, size_t slot, const Vec2f& pos) {
+            const __m256 px = _mm256_set1_ps(pos.x);
+            const __m256 py = _mm256_set1_ps(pos.y);
+            const __m256 in_x = _mm256_and_ps(_mm256_cmp_ps(px, _mm256_loadu_ps(&index.box_min_x[slot]), _CMP_GE_OQ),
+                                              _mm256_cmp_ps(px, _mm256_loadu_ps(&index.box_max_x[slot]), _CMP_LE_OQ));
+            const __m256 in_y = _mm256_and_ps(_mm256_cmp_ps(py, _mm256_loadu_ps(&index.box_min_y[slot]), _CMP_GE_OQ),
+                                              _mm256_cmp_ps(py, _mm256_loadu_ps(&index.box_max_y[slot]), _CMP_LE_OQ));
+            return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(in_x, in_y)));
+        }
+#elif defined(PATHFINDER_SSE2)
+        uint32_t TrapezoidBoxMask4(const TrapezoidIndex& index, size_t slot, const __m128& px, const __m128& py) {
+            const __m128 in_x = _mm_and_ps(_mm_cmpge_ps(px, _mm_loadu_ps(&index.box_min_x[slot])),
+                                           _mm_cmple_ps(px, _mm_loadu_ps(&index.box_max_x[slot])));
+            const __m128 in_y = _mm_and_ps(_mm_cmpge_ps(py, _mm_loadu_ps(&index.box_min_y[slot])),
+                                           _mm_cmple_ps(py, _mm_loadu_ps(&index.box_max_y[slot])));
+            return static_cast<uint32_t>(_mm_movemask_ps(_mm_and_ps(in_x, in_y)));
+        }
+
+        uint32_t TrapezoidBoxMask(const TrapezoidIndex& index, size_t slot, const Vec2f& pos) {
+            const __m128 px = _mm_set1_ps(pos.x);
+            const __m128 py = _mm_set1_ps(pos.y);
+            return TrapezoidBoxMask4(index, slot, px, py) | (TrapezoidBoxMask4(index, slot + 4, px, py) << 4);
+        }
+#else
+        uint32_t TrapezoidBoxMask(const TrapezoidIndex& index, size_t slot, const Vec2f& pos) {
+            uint32_t mask = 0;
+            for (uint32_t lane = 0; lane < kTrapezoidLanes; ++lane) {
+                if (pos.x >= index.box_min_x[slot + lane] && pos.x <= index.box_max_x[slot + lane] &&
+                    pos.y >= index.box_min_y[slot + lane] && pos.y <= index.box_max_y[slot + lane]) {
+                    mask |= 1u << lane;
                 }
-                if (stats.contains("travel_portal_count")) {
-                    out_map_data.stats.travel_portal_count = stats["travel_portal_count"].get<int32_t>();
+            }
+            return mask;
+        }
+#endif
+    }
+
+    void TrapezoidIndex::Build(const std::vector<Trapezoid>& trapezoids) {
+        box_min_x.clear();
+        box_min_y.clear();
+        box_max_x.clear();
+        box_max_y.clear();
+
+        if (trapezoids.empty()) {
+            grid = UniformGrid();
+            return;
+        }
+
+        std::vector<Vec2f> box_min;
+        std::vector<Vec2f> box_max;
+        box_min.reserve(trapezoids.size());
+        box_max.reserve(trapezoids.size());
+
+        float total_area = 0.0f;
+        for (const auto& trap : trapezoids) {
+            Vec2f lo(std::min({trap.a.x, trap.b.x, trap.c.x, trap.d.x}), std::min({trap.a.y, trap.b.y, trap.c.y, trap.d.y}));
+            Vec2f hi(std::max({trap.a.x, trap.b.x, trap.c.x, trap.d.x}), std::max({trap.a.y, trap.b.y, trap.c.y, trap.d.y}));
+            box_min.push_back(lo);
+            box_max.push_back(hi);
+            total_area += (hi.x - lo.x) * (hi.y - lo.y);
+        }
+
+        // Cells about the size of an average trapezoid keep buckets short
+        // without duplicating large trapezoids over too many cells
+        float cell = std::sqrt(total_area / static_cast<float>(trapezoids.size()));
+        cell = std::min(std::max(cell, 64.0f), 4096.0f);
+        grid.Build(box_min, box_max, cell);
+
+        // Padding slots have NaN boxes, which fail every comparison of the test
+        const size_t slot_count = grid.items.size() + kTrapezoidLanes;
+        box_min_x.assign(slot_count, std::numeric_limits<float>::quiet_NaN());
+        box_min_y.assign(slot_count, std::numeric_limits<float>::quiet_NaN());
+        box_max_x.assign(slot_count, std::numeric_limits<float>::quiet_NaN());
+        box_max_y.assign(slot_count, std::numeric_limits<float>::quiet_NaN());
+        for (size_t slot = 0; slot < grid.items.size(); ++slot) {
+            const int32_t trap_index = grid.items[slot];
+            box_min_x[slot] = box_min[trap_index].x;
+            box_min_y[slot] = box_min[trap_index].y;
+            box_max_x[slot] = box_max[trap_index].x;
+            box_max_y[slot] = box_max[trap_index].y;
+        }
+    }
+
+    int32_t TrapezoidIndex::FindContaining(const std::vector<Trapezoid>& trapezoids, const Vec2f& pos, int32_t layer) const {
+        if (grid.Empty()) {
+            return -1;
+        }
+
+        const int32_t cell = grid.CellIndex(grid.CellX(pos.x), grid.CellY(pos.y));
+        const uint32_t end = grid.cell_offsets[cell + 1];
+        for (uint32_t slot = grid.cell_offsets[cell]; slot < end; slot += kTrapezoidLanes) {
+            uint32_t mask = TrapezoidBoxMask(*this, slot, pos);
+            if (end - slot < kTrapezoidLanes) {
+                mask &= (1u << (end - slot)) - 1; // Lanes past the cell belong to the next one
+            }
+
+            // Lanes are in map order, so the first trapezoid accepted is the first in the map
+            for (uint32_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+                if ((mask & 1) == 0) {
+                    continue;
                 }
-                if (stats.contains("npc_travel_count")) {
-                    out_map_data.stats.npc_travel_count = stats["npc_travel_count"].get<int32_t>();
+
+                const int32_t trap_index = grid.items[slot + lane];
+                const Trapezoid& trap = trapezoids[trap_index];
+                if ((layer < 0 || trap.layer == layer) && trap.ContainsPoint(pos)) {
+                    return trap_index;
                 }
-                if (stats.contains("enter_travel_count")) {
-                    out_map_data.stats.enter_travel_count = stats["enter_travel_count"].get<int32_t>();
+            }
+        }
+        return -1;
+    }
+
+    void ObstacleIndex::Build(const std::vector<ObstacleZone>& obstacles) {
+        box_min.clear();
+        box_max.clear();
+        near_x.clear();
+        near_y.clear();
+        near_radius_sq.clear();
+        selected_stamps.assign(obstacles.size(), 0);
+        selection_stamp = 0;
+        if (obstacles.empty()) {
+            grid.cell_offsets.clear();
+            grid.items.clear();
+            return;
+        }
+
+        float total_diameter = 0.0f;
+        Vec2f lo(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+        Vec2f hi(-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity());
+        for (const auto& obstacle : obstacles) {
+            const float radius = std::max(obstacle.radius, 0.0f);
+            box_min.emplace_back(obstacle.center.x - radius, obstacle.center.y - radius);
+            box_max.emplace_back(obstacle.center.x + radius, obstacle.center.y + radius);
+            lo.x = std::min(lo.x, box_min.back().x);
+            lo.y = std::min(lo.y, box_min.back().y);
+            hi.x = std::max(hi.x, box_max.back().x);
+            hi.y = std::max(hi.y, box_max.back().y);
+            total_diameter += 2.0f * radius;
+        }
+
+        // Cells about the size of an average obstacle, but no more cells than obstacles
+        // so that building the grid stays cheap next to the search
+        const float count = static_cast<float>(obstacles.size());
+        float cell = std::max(total_diameter / count, std::sqrt((hi.x - lo.x) * (hi.y - lo.y) / count));
+        cell = std::min(std::max(cell, 50.0f), 16384.0f);
+        grid.Build(box_min, box_max, cell);
+    }
+
+    void ObstacleIndex::SelectNear(const std::vector<ObstacleZone>& obstacles, const Vec2f& pos, float reach) {
+        near_x.clear();
+        near_y.clear();
+        near_radius_sq.clear();
+
+        // Only the cells overlapping the square of half-side reach around pos can hold a near obstacle
+        const float grid_max_x = grid.origin.x + grid.cols * grid.cell_size;
+        const float grid_max_y = grid.origin.y + grid.rows * grid.cell_size;
+        if (!grid.Empty() &&
+            pos.x + reach >= grid.origin.x && pos.x - reach <= grid_max_x &&
+            pos.y + reach >= grid.origin.y && pos.y - reach <= grid_max_y) {
+            if (++selection_stamp == 0) {
+                std::fill(selected_stamps.begin(), selected_stamps.end(), 0);
+                selection_stamp = 1;
+            }
+
+            const int32_t x_end = grid.CellX(pos.x + reach);
+            const int32_t y_end = grid.CellY(pos.y + reach);
+            for (int32_t cy = grid.CellY(pos.y - reach); cy <= y_end; ++cy) {
+                for (int32_t cx = grid.CellX(pos.x - reach); cx <= x_end; ++cx) {
+                    const int32_t cell = grid.CellIndex(cx, cy);
+                    for (uint32_t i = grid.cell_offsets[cell]; i < grid.cell_offsets[cell + 1]; ++i) {
+                        const int32_t index = grid.items[i];
+                        if (selected_stamps[index] == selection_stamp) {
+                            continue;
+                        }
+                        selected_stamps[index] = selection_stamp;
+
+                        const ObstacleZone& obstacle = obstacles[index];
+                        const float limit = reach + obstacle.radius;
+                        if (obstacle.radius >= 0.0f && obstacle.center.SquaredDistance(pos) <= limit * limit) {
+                            near_x.push_back(obstacle.center.x);
+                            near_y.push_back(obstacle.center.y);
+                            near_radius_sq.push_back(obstacle.radius_squared);
+                        }
+                    }
                 }
             }
+        }
 
-            return out_map_data.IsValid();
+        // Far away padding circles with a negative squared radius fail every lane of the test
+        while (near_x.size() % kObstacleLanes != 0) {
+            near_x.push_back(kPaddingCoordinate);
+            near_y.push_back(kPaddingCoordinate);
+            near_radius_sq.push_back(-1.0f);
         }
-        catch (const std::exception&) {
-            return false;
+    }
+
+    bool ObstacleIndex::IntersectsSegment(const Vec2f& from, const Vec2f& to) const {
+        // Closest point of the segment to each center: from + t * (to - from), t clamped to [0, 1]
+        // A zero-length segment gets t = 0, i.e. a point test
+        const float dx = to.x - from.x;
+        const float dy = to.y - from.y;
+        const float length_sq = dx * dx + dy * dy;
+        const float inv_length_sq = length_sq > 0.0f ? 1.0f / length_sq : 0.0f;
+        const size_t count = near_x.size();
+
+#if defined(PATHFINDER_AVX2)
+        const __m256 from_x8 = _mm256_set1_ps(from.x);
+        const __m256 from_y8 = _mm256_set1_ps(from.y);
+        const __m256 dx8 = _mm256_set1_ps(dx);
+        const __m256 dy8 = _mm256_set1_ps(dy);
+        const __m256 inv8 = _mm256_set1_ps(inv_length_sq);
+        const __m256 zero8 = _mm256_setzero_ps();
+        const __m256 one8 = _mm256_set1_ps(1.0f);
+        for (size_t i = 0; i < count; i += 8) {
+            const __m256 ox = _mm256_sub_ps(_mm256_loadu_ps(&near_x[i]), from_x8);
+            const __m256 oy = _mm256_sub_ps(_mm256_loadu_ps(&near_y[i]), from_y8);
+            __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(ox, dx8), _mm256_mul_ps(oy, dy8)), inv8);
+            t = _mm256_min_ps(_mm256_max_ps(t, zero8), one8);
+            const __m256 ex = _mm256_sub_ps(ox, _mm256_mul_ps(t, dx8));
+            const __m256 ey = _mm256_sub_ps(oy, _mm256_mul_ps(t, dy8));
+            const __m256 dist_sq = _mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey));
+            if (_mm256_movemask_ps(_mm256_cmp_ps(dist_sq, _mm256_loadu_ps(&near_radius_sq[i]), _CMP_LE_OQ)) != 0) {
+                return true;
+            }
+        }
+        return false;
+#elif defined(PATHFINDER_SSE2)
+        const __m128 from_x4 = _mm_set1_ps(from.x);
+        const __m128 from_y4 = _mm_set1_ps(from.y);
+        const __m128 dx4 = _mm_set1_ps(dx);
+        const __m128 dy4 = _mm_set1_ps(dy);
+        const __m128 inv4 = _mm_set1_ps(inv_length_sq);
+        const __m128 zero4 = _mm_setzero_ps();
+        const __m128 one4 = _mm_set1_ps(1.0f);
+        for (size_t i = 0; i < count; i += 4) {
+            const __m128 ox = _mm_sub_ps(_mm_loadu_ps(&near_x[i]), from_x4);
+            const __m128 oy = _mm_sub_ps(_mm_loadu_ps(&near_y[i]), from_y4);
+            __m128 t = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(ox, dx4), _mm_mul_ps(oy, dy4)), inv4);
+            t = _mm_min_ps(_mm_max_ps(t, zero4), one4);
+            const __m128 ex = _mm_sub_ps(ox, _mm_mul_ps(t, dx4));
+            const __m128 ey = _mm_sub_ps(oy, _mm_mul_ps(t, dy4));
+            const __m128 dist_sq = _mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey));
+            if (_mm_movemask_ps(_mm_cmple_ps(dist_sq, _mm_loadu_ps(&near_radius_sq[i]))) != 0) {
+                return true;
+            }
+        }
+        return false;
+#else
+        for (size_t i = 0; i < count; ++i) {
+            const float ox = near_x[i] - from.x;
+            const float oy = near_y[i] - from.y;
+            const float t = std::min(std::max((ox * dx + oy * dy) * inv_length_sq, 0.0f), 1.0f);
+            const float ex = ox - t * dx;
+            const float ey = oy - t * dy;
+            if (ex * ex + ey * ey <= near_radius_sq[i]) {
+                return true;
+            }
+        }
+        return false;
+#endif
+    }
+
+    void PointIndex::Build(const std::vector<Point>& points) {
+        if (points.empty()) {
+            grid = UniformGrid();
+            return;
+        }
+
+        std::vector<Vec2f> positions;
+        positions.reserve(points.size());
+        Vec2f lo = points[0].pos;
+        Vec2f hi = points[0].pos;
+        for (const auto& point : points) {
+            positions.push_back(point.pos);
+            lo.x = std::min(lo.x, point.pos.x);
+            lo.y = std::min(lo.y, point.pos.y);
+            hi.x = std::max(hi.x, point.pos.x);
+            hi.y = std::max(hi.y, point.pos.y);
+        }
+
+        // About 4 points per cell on average
+        float area = std::max((hi.x - lo.x) * (hi.y - lo.y), 1.0f);
+        float cell = std::sqrt(area * 4.0f / static_cast<float>(points.size()));
+        cell = std::min(std::max(cell, 50.0f), 4096.0f);
+        grid.Build(positions, positions, cell);
+    }
+
+    std::vector<PathPointWithLayer> PathfinderEngine::FindPathWithObstacles(
+        int32_t map_id,
+        const Vec2f& start,
+        int32_t start_layer,
+        const Vec2f& goal,
+        const std::vector<ObstacleZone>& obstacles,
+        float& out_cost,
+        SearchDirection direction
+    ) {
+        // The reference keeps the map alive even if the cache evicts it during the query
+        std::shared_ptr<const MapData> map_data = m_map_cache.Find(map_id);
+        if (!map_data) {
+            out_cost = -1.0f;
+            return {}; // Map not loaded
         }
+
+        return FindPathWithObstacles(*map_data, start, start_layer, goal, obstacles, out_cost, direction);
     }
 
     std::vector<PathPointWithLayer> PathfinderEngine::FindPathWithObstacles(
-        int32_t map_id,
+        const MapData& map_data,
+        const Vec2f& start,
+        int32_t start_layer,
+        const Vec2f& goal,
+        const std::vector<ObstacleZone>& obstacles,
+        float& out_cost,
+        SearchDirection direction
+    ) {
+        std::vector<PathPointWithLayer> path;
+        FindPathWithObstacles(map_data, start, start_layer, goal, obstacles, path, out_cost, direction);
+        return path;
+    }
+
+    bool PathfinderEngine::FindPathWithObstacles(
+        const MapData& map_data,
         const Vec2f& start,
         int32_t start_layer,
         const Vec2f& goal,
         const std::vector<ObstacleZone>& obstacles,
-        float& out_cost
+        std::vector<PathPointWithLayer>& out_path,
+        float& out_cost,
+        SearchDirection direction
     ) {
         out_cost = -1.0f;
+        out_path.clear();
 
         try {
             // Check if start and goal are the same (or very close)
@@ -233,289 +963,527 @@ namespace Pathfinder {
             float dist_sq = start.SquaredDistance(goal);
             if (dist_sq < 100.0f) { // Less than 10 units apart
                 out_cost = 0.0f;
-                std::vector<PathPointWithLayer> path;
-                path.emplace_back(goal, start_layer >= 0 ? start_layer : 0);
-                return path;
-            }
-
-            auto it = m_loaded_maps.find(map_id);
-            if (it == m_loaded_maps.end()) {
-                return {}; // Map not loaded
+                out_path.emplace_back(goal, start_layer >= 0 ? start_layer : 0);
+                return true;
             }
 
             // Validate map data before proceeding
-            if (it->second.points.empty() || it->second.visibility_graph.empty()) {
-                return {}; // Invalid map data
+            if (map_data.points.empty() || map_data.visibility_graph.Empty()) {
+                return false; // Invalid map data
             }
 
-            // Make a COPY of map_data for temporary point insertion
-            // This ensures we don't corrupt the original data
-            MapData map_data = it->second;
+            // Temporary points live in a query-local overlay on top of the shared map data
+            // The loaded MapData is never copied nor modified
+            SearchContext& context = GetThreadSearchContext();
+            context.open_set.SetIndexed(GetIndexedOpenSet());
+            QueryGraph graph(map_data, context);
 
-        // Track if goal was found in a trapezoid or used fallback
+        int32_t start_id = -1;
+        int32_t goal_id = -1;
         bool goal_used_fallback = false;
+        if (!AttachQueryPoints(graph, start, start_layer, goal, start_id, goal_id, goal_used_fallback)) {
+            return false;
+        }
 
-        // Create temporary start point
-        int32_t start_id = -1;
+        // Start and goal in parts of the graph that never meet: no search can succeed
+        if (!ComponentsConnect(graph, start_id, goal_id, context)) {
+            return false;
+        }
+
+        // Queries left in Auto direction search from both ends past the distance set by the options
+        const BidirectionalSearchOptions bidirectional = GetBidirectionalSearch();
+        if (direction == SearchDirection::Auto) {
+            const bool far = start.SquaredDistance(goal) >= bidirectional.min_distance * bidirectional.min_distance;
+            direction = bidirectional.enabled && far ? SearchDirection::Bidirectional : SearchDirection::Forward;
+        }
+
+        // Without obstacles the contraction hierarchy applies, otherwise A* with obstacle avoidance runs
+        // over the cluster level when the map has one, else from one or both ends
+        std::vector<PathPointWithLayer>& path = out_path;
+        bool found = false;
+        if (obstacles.empty() && !map_data.contraction_hierarchy.Empty()) {
+            SearchContext& backward_context = GetThreadBackwardSearchContext();
+            backward_context.open_set.SetIndexed(context.open_set.Indexed());
+            if (ContractionHierarchySearch(graph, start_id, goal_id, context, backward_context)) {
+                path.reserve(context.path_nodes.size());
+                for (int32_t id : context.path_nodes) {
+                    path.emplace_back(graph.GetPoint(id).pos, graph.GetPoint(id).layer);
+                }
+                found = true;
+            }
+        }
+        else if (!map_data.hierarchical_graph.Empty()) {
+            if (HierarchicalSearch(graph, start_id, goal_id, obstacles, GetObstacleEdgeTest(), context)) {
+                path.reserve(context.path_nodes.size());
+                for (int32_t id : context.path_nodes) {
+                    path.emplace_back(graph.GetPoint(id).pos, graph.GetPoint(id).layer);
+                }
+                found = true;
+            }
+        }
+        else if (direction == SearchDirection::Bidirectional && map_data.symmetric_graph) {
+            SearchContext& backward_context = GetThreadBackwardSearchContext();
+            backward_context.open_set.SetIndexed(context.open_set.Indexed());
+            const TaskScheduler* scheduler = bidirectional.parallel && m_search_scheduler ? &m_search_scheduler : nullptr;
+            if (BidirectionalAStar(graph, start_id, goal_id, obstacles, GetObstacleEdgeTest(), context,
+                                   backward_context, scheduler)) {
+                path.reserve(context.path_nodes.size());
+                for (int32_t id : context.path_nodes) {
+                    path.emplace_back(graph.GetPoint(id).pos, graph.GetPoint(id).layer);
+                }
+                found = true;
+            }
+        }
+        else if (AStarWithObstacles(graph, start_id, goal_id, obstacles, GetObstacleEdgeTest(), context)) {
+            // Reconstruct the path (includes start point since it's a temp point)
+            ReconstructPathWithStart(graph, context, start_id, goal_id, path);
+            found = true;
+        }
+
+        if (found) {
+            // If goal used fallback, add the original goal position at the end
+            if (goal_used_fallback && !path.empty()) {
+                int32_t goal_layer = path.back().layer; // Use same layer as last point
+                path.emplace_back(goal, goal_layer);
+            }
+
+            // Calculate total cost: the walked length, teleporter jumps cost what the graph charges for them
+            out_cost = 0.0f;
+            for (size_t i = 1; i < path.size(); ++i) {
+                out_cost += map_data.IsTeleporterHop(path[i - 1].pos, path[i].pos)
+                    ? kTeleporterCost
+                    : path[i - 1].pos.Distance(path[i].pos);
+            }
+        }
+
+        // No need to clean up - the overlay is local to this query
 
+        return found;
+
+        } catch (const SearchError&) {
+            throw; // The search did not run to its end: not a missing path
+        } catch (const std::exception&) {
+            out_path.clear();
+            return false; // Return empty path on any exception
+        } catch (...) {
+            out_path.clear();
+            return false; // Catch any other exception
+        }
+    }
+
+    bool PathfinderEngine::AttachQueryPoints(
+        QueryGraph& graph,
+        const Vec2f& start,
+        int32_t start_layer,
+        const Vec2f& goal,
+        int32_t& out_start_id,
+        int32_t& out_goal_id,
+        bool& out_goal_used_fallback
+    ) {
+        out_start_id = -1;
+        out_goal_id = -1;
+        out_goal_used_fallback = false;
+
+        // Create temporary start point
         if (start_layer >= 0) {
             // User specified a layer - create a forced point with this layer
-            start_id = CreateTemporaryPointWithLayer(map_data, start, start_layer);
-            if (start_id >= 0) {
+            out_start_id = CreateTemporaryPointWithLayer(graph, start, start_layer);
+            if (out_start_id >= 0) {
                 // Connect to nearby points on the SAME layer only
-                InsertPointIntoVisGraph(map_data, start_id, 8, 5000.0f, false);
+                InsertPointIntoVisGraph(graph, out_start_id, 8, 5000.0f, false);
             }
         } else {
             // Auto-detect layer from trapezoid or nearby points
-            start_id = CreateTemporaryPoint(map_data, start);
-            if (start_id >= 0) {
-                InsertPointIntoVisGraph(map_data, start_id, 8, 5000.0f);
+            out_start_id = CreateTemporaryPoint(graph, start);
+            if (out_start_id >= 0) {
+                InsertPointIntoVisGraph(graph, out_start_id, 8, 5000.0f);
             }
         }
 
-        if (start_id < 0) {
+        if (out_start_id < 0) {
             // Position not on a trapezoid and no layer specified - create a forced point
-            start_id = CreateTemporaryPointForced(map_data, start);
-            if (start_id < 0) {
-                return {}; // No valid start point
+            out_start_id = CreateTemporaryPointForced(graph, start);
+            if (out_start_id < 0) {
+                return false; // No valid start point
             }
             // Connect to nearby points, allowing cross-layer connections
-            InsertPointIntoVisGraph(map_data, start_id, 8, 5000.0f, true);
+            InsertPointIntoVisGraph(graph, out_start_id, 8, 5000.0f, true);
         }
 
         // Create temporary goal point
-        int32_t goal_id = CreateTemporaryPoint(map_data, goal);
-        if (goal_id < 0) {
+        out_goal_id = CreateTemporaryPoint(graph, goal);
+        if (out_goal_id < 0) {
             // Position not on a trapezoid - create a temporary point anyway at this position
-            goal_id = CreateTemporaryPointForced(map_data, goal);
-            goal_used_fallback = true;
-            if (goal_id < 0) {
-                return {}; // No valid goal point
+            out_goal_id = CreateTemporaryPointForced(graph, goal);
+            out_goal_used_fallback = true;
+            if (out_goal_id < 0) {
+                return false; // No valid goal point
             }
             // Connect to nearby points, allowing cross-layer connections
-            InsertPointIntoVisGraph(map_data, goal_id, 8, 5000.0f, true);
+            InsertPointIntoVisGraph(graph, out_goal_id, 8, 5000.0f, true);
         } else {
             // Insert the temporary point into the visibility graph
-            InsertPointIntoVisGraph(map_data, goal_id, 8, 5000.0f);
+            InsertPointIntoVisGraph(graph, out_goal_id, 8, 5000.0f);
         }
 
-        // Run A* with obstacle avoidance
-        std::vector<int32_t> came_from = AStarWithObstacles(map_data, start_id, goal_id, obstacles);
+        return true;
+    }
 
-        std::vector<PathPointWithLayer> path;
-        if (!came_from.empty()) {
-            // Reconstruct the path (includes start point since it's a temp point)
-            path = ReconstructPathWithStart(map_data, came_from, start_id, goal_id);
+    bool PathfinderEngine::ComponentsConnect(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        SearchContext& context
+    ) {
+        const ComponentIndex& components = graph.base.components;
+        if (components.NodeCount() != graph.BaseCount()) {
+            return true;
+        }
 
-            // If goal used fallback, add the original goal position at the end
-            if (goal_used_fallback && !path.empty()) {
-                int32_t goal_layer = path.back().layer; // Use same layer as last point
-                path.emplace_back(goal, goal_layer);
+        // Temporary points are linked both ways to their nearest points (and maybe to each other)
+        // Everything the start's components reach is marked first, then the goal's components are looked up
+        ComponentMarks& marks = context.component_marks;
+        marks.Begin(components.ComponentCount());
+        for (const auto& from : graph.overlay_edges) {
+            if (from.first != start_id) {
+                continue;
             }
-
-            // Calculate total cost
-            out_cost = 0.0f;
-            for (size_t i = 1; i < path.size(); ++i) {
-                out_cost += path[i - 1].pos.Distance(path[i].pos);
+            if (from.second.target_id == goal_id) {
+                return true;
+            }
+            if (!graph.IsTemporary(from.second.target_id)) {
+                components.MarkReached(components.components[from.second.target_id], marks);
             }
         }
 
-        // No need to clean up - map_data is a local copy that will be destroyed
+        for (const auto& to : graph.overlay_edges) {
+            if (to.first == goal_id && !graph.IsTemporary(to.second.target_id) &&
+                marks.IsMarked(components.components[to.second.target_id])) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-        return path;
+    bool PathfinderEngine::IsReachable(const MapData& map_data, const Vec2f& start, int32_t start_layer, const Vec2f& goal) {
+        try {
+            if (start.SquaredDistance(goal) < 100.0f) {
+                return true; // Same as the single-point path of FindPathWithObstacles
+            }
+            if (map_data.points.empty() || map_data.visibility_graph.Empty()) {
+                return false;
+            }
 
-        } catch (const std::exception&) {
-            return {}; // Return empty path on any exception
+            SearchContext& context = GetThreadSearchContext();
+            QueryGraph graph(map_data, context);
+            int32_t start_id = -1;
+            int32_t goal_id = -1;
+            bool goal_used_fallback = false;
+            return AttachQueryPoints(graph, start, start_layer, goal, start_id, goal_id, goal_used_fallback)
+                && ComponentsConnect(graph, start_id, goal_id, context);
         } catch (...) {
-            return {}; // Catch any other exception
+            return false;
         }
     }
 
-    std::vector<int32_t> PathfinderEngine::AStar(
-        const MapData& map_data,
+    SearchContext& PathfinderEngine::GetThreadSearchContext() {
+        // One context per thread, shared by all maps: the buffers grow to the largest map searched
+        // and the generation stamps make reusing them across maps free
+        thread_local SearchContext context;
+        return context;
+    }
+
+    SearchContext& PathfinderEngine::GetThreadBackwardSearchContext() {
+        thread_local SearchContext context;
+        return context;
+    }
+
+    bool PathfinderEngine::ContractionHierarchySearch(
+        const QueryGraph& graph,
         int32_t start_id,
-        int32_t goal_id
+        int32_t goal_id,
+        SearchContext& context,
+        SearchContext& backward_context
     ) {
-        if (start_id < 0 || start_id >= static_cast<int32_t>(map_data.points.size()) ||
-            goal_id < 0 || goal_id >= static_cast<int32_t>(map_data.points.size())) {
-            return {};
+        const ContractionHierarchy& ch = graph.base.contraction_hierarchy;
+        if (!graph.IsValidId(start_id) || !graph.IsValidId(goal_id) || ch.NodeCount() != graph.BaseCount()) {
+            return false;
         }
 
-        // Priority queue: (priority, node_id)
-        using PQElement = std::pair<float, int32_t>;
-        std::priority_queue<PQElement, std::vector<PQElement>, std::greater<PQElement>> open_set;
-
-        std::vector<float> cost_so_far(map_data.points.size(), std::numeric_limits<float>::infinity());
-        std::vector<int32_t> came_from(map_data.points.size(), -1);
+        OpenSet& forward_set = context.open_set;
+        OpenSet& backward_set = backward_context.open_set;
 
-        cost_so_far[start_id] = 0.0f;
-        came_from[start_id] = start_id;
-        open_set.emplace(0.0f, start_id);
+        context.Begin(graph.PointCount());
+        backward_context.Begin(graph.PointCount());
+        context.Update(start_id, 0.0f, start_id);
+        backward_context.Update(goal_id, 0.0f, goal_id);
 
-        const bool has_teleporters = !map_data.teleporters.empty();
-        int32_t current_id = -1;
+        float best_cost = std::numeric_limits<float>::infinity();
+        int32_t meeting_id = -1;
 
-        while (!open_set.empty()) {
-            current_id = open_set.top().second;
-            open_set.pop();
+        // The temporary points only have overlay edges: seed both searches with the base points they
+        // connect to, exactly the first and last hops A* could take
+        for (const auto& extra : graph.overlay_edges) {
+            const int32_t from = extra.first;
+            const int32_t to = extra.second.target_id;
+            const float distance = extra.second.distance;
 
-            if (current_id == goal_id) {
-                break; // Path found
+            if (from == start_id && to == goal_id) {
+                if (distance < best_cost) {
+                    best_cost = distance;
+                    meeting_id = goal_id;
+                }
             }
+            else if (from == start_id && !graph.IsTemporary(to) && distance < context.Cost(to)) {
+                context.Update(to, distance, start_id);
+                forward_set.Push(distance, to);
+            }
+            else if (to == goal_id && !graph.IsTemporary(from) && distance < backward_context.Cost(from)) {
+                backward_context.Update(from, distance, goal_id);
+                backward_set.Push(distance, from);
+            }
+        }
 
-            // Explore neighbors
-            if (current_id >= 0 && current_id < static_cast<int32_t>(map_data.visibility_graph.size())) {
-                const auto& edges = map_data.visibility_graph[current_id];
-
-                for (const auto& edge : edges) {
-                    int32_t neighbor_id = edge.target_id;
-                    if (neighbor_id < 0 || neighbor_id >= static_cast<int32_t>(map_data.points.size())) {
-                        continue;
-                    }
-
-                    float new_cost = cost_so_far[current_id] + edge.distance;
-
-                    if (new_cost < cost_so_far[neighbor_id]) {
-                        cost_so_far[neighbor_id] = new_cost;
-                        came_from[neighbor_id] = current_id;
+        // Both searches only climb, each one stops once its smallest key cannot improve the best path
+        const float infinity = std::numeric_limits<float>::infinity();
+        for (;;) {
+            const float forward_min = forward_set.Empty() ? infinity : forward_set.MinPriority();
+            const float backward_min = backward_set.Empty() ? infinity : backward_set.MinPriority();
+            if (std::min(forward_min, backward_min) >= best_cost) {
+                break;
+            }
 
-                        // Calculate priority with heuristic
-                        float priority = new_cost;
+            const bool forward = forward_min <= backward_min;
+            SearchContext& own = forward ? context : backward_context;
+            const SearchContext& other = forward ? backward_context : context;
+            OpenSet& open_set = own.open_set;
 
-                        if (has_teleporters) {
-                            const Vec2f& neighbor_pos = map_data.points[neighbor_id].pos;
-                            const Vec2f& goal_pos = map_data.points[goal_id].pos;
+            const OpenSet::Entry current = open_set.Pop();
 
-                            float direct_dist = neighbor_pos.Distance(goal_pos);
-                            float tp_dist = TeleporterHeuristic(map_data, neighbor_pos, goal_pos);
+            const int32_t current_id = current.second;
+            if (current.first > own.Cost(current_id)) {
+                continue; // Stale entry
+            }
 
-                            priority += std::min(direct_dist, tp_dist);
-                        } else {
-                            const Vec2f& neighbor_pos = map_data.points[neighbor_id].pos;
-                            const Vec2f& goal_pos = map_data.points[goal_id].pos;
-                            priority += neighbor_pos.Distance(goal_pos);
-                        }
+            const float meet_cost = current.first + other.Cost(current_id);
+            if (meet_cost < best_cost) {
+                best_cost = meet_cost;
+                meeting_id = current_id;
+            }
 
-                        open_set.emplace(priority, neighbor_id);
-                    }
+            const uint32_t begin = forward ? ch.up_offsets[current_id] : ch.down_offsets[current_id];
+            const uint32_t end = forward ? ch.up_offsets[current_id + 1] : ch.down_offsets[current_id + 1];
+            const int32_t* neighbors = forward ? ch.up_targets.data() : ch.down_sources.data();
+            const float* weights = forward ? ch.up_weights.data() : ch.down_weights.data();
+
+            for (uint32_t e = begin; e < end; ++e) {
+                const int32_t neighbor_id = neighbors[e];
+                const float new_cost = current.first + weights[e];
+                if (new_cost < own.Cost(neighbor_id)) {
+                    own.Update(neighbor_id, new_cost, current_id);
+                    open_set.Push(new_cost, neighbor_id);
                 }
             }
         }
 
-        if (current_id != goal_id) {
-            return {}; // No path found
+        if (meeting_id < 0) {
+            return false;
+        }
+
+        // Hierarchy path: start -> ... -> meeting through the forward tree, then down to the goal
+        // (built in the backward context's buffer, then expanded into the forward one)
+        std::vector<int32_t>& hierarchy_nodes = backward_context.path_nodes;
+        hierarchy_nodes.clear();
+        if (meeting_id == goal_id) {
+            hierarchy_nodes.push_back(start_id);
         }
+        else {
+            for (int32_t id = meeting_id; id != start_id; id = context.CameFrom(id)) {
+                hierarchy_nodes.push_back(id);
+            }
+            hierarchy_nodes.push_back(start_id);
+            std::reverse(hierarchy_nodes.begin(), hierarchy_nodes.end());
 
-        return came_from;
+            for (int32_t id = backward_context.CameFrom(meeting_id); id != goal_id; id = backward_context.CameFrom(id)) {
+                hierarchy_nodes.push_back(id);
+            }
+        }
+        hierarchy_nodes.push_back(goal_id);
+
+        // Expand the shortcuts between base points; the hops touching temporary points are overlay edges
+        std::vector<int32_t>& nodes = context.path_nodes;
+        nodes.clear();
+        nodes.push_back(start_id);
+        for (size_t i = 1; i < hierarchy_nodes.size(); ++i) {
+            const int32_t from = hierarchy_nodes[i - 1];
+            const int32_t to = hierarchy_nodes[i];
+            if (graph.IsTemporary(from) || graph.IsTemporary(to)) {
+                nodes.push_back(to);
+            }
+            else if (!ch.Unpack(from, to, nodes)) {
+                return false;
+            }
+        }
+        return true;
     }
 
-    std::vector<int32_t> PathfinderEngine::AStarWithObstacles(
-        const MapData& map_data,
+    bool PathfinderEngine::AStarWithObstacles(
+        const QueryGraph& graph,
         int32_t start_id,
         int32_t goal_id,
-        const std::vector<ObstacleZone>& obstacles
+        const std::vector<ObstacleZone>& obstacles,
+        bool block_crossing_edges,
+        SearchContext& context
     ) {
-        if (start_id < 0 || start_id >= static_cast<int32_t>(map_data.points.size()) ||
-            goal_id < 0 || goal_id >= static_cast<int32_t>(map_data.points.size())) {
-            return {};
+        if (!graph.IsValidId(start_id) || !graph.IsValidId(goal_id)) {
+            return false;
         }
 
-        // Priority queue: (priority, node_id)
-        using PQElement = std::pair<float, int32_t>;
-        std::priority_queue<PQElement, std::vector<PQElement>, std::greater<PQElement>> open_set;
-
-        std::vector<float> cost_so_far(map_data.points.size(), std::numeric_limits<float>::infinity());
-        std::vector<int32_t> came_from(map_data.points.size(), -1);
+        HeuristicGoal goal;
+        BeginHeuristic(graph, goal_id, goal);
+        return SearchKernelWithObstacles(graph, start_id, goal_id, GraphEdges(graph), obstacles, block_crossing_edges,
+                                         goal, context);
+    }
 
-        cost_so_far[start_id] = 0.0f;
-        came_from[start_id] = start_id;
-        open_set.emplace(0.0f, start_id);
+    bool PathfinderEngine::BidirectionalAStar(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        const std::vector<ObstacleZone>& obstacles,
+        bool block_crossing_edges,
+        SearchContext& context,
+        SearchContext& backward_context,
+        const TaskScheduler* scheduler
+    ) {
+        if (!graph.IsValidId(start_id) || !graph.IsValidId(goal_id) || !graph.base.symmetric_graph) {
+            return false;
+        }
 
-        const bool has_teleporters = !map_data.teleporters.empty();
-        int32_t current_id = -1;
+        // On a symmetric graph the distance to the start is the distance from it: the backward frontier
+        // uses the heuristic towards the start as is
+        HeuristicGoal forward_goal;
+        HeuristicGoal backward_goal;
+        BeginHeuristic(graph, goal_id, forward_goal);
+        BeginHeuristic(graph, start_id, backward_goal);
+
+        // Each frontier has its own obstacle index and blocked-node flags, so they can run on two threads
+        if (obstacles.empty()) {
+            NoObstacles forward_filter;
+            NoObstacles backward_filter;
+            return BidirectionalKernelWithGoal(graph, start_id, goal_id, forward_filter, backward_filter,
+                                               forward_goal, backward_goal, context, backward_context, scheduler);
+        }
+        if (!block_crossing_edges) {
+            NodeObstacles forward_filter(graph, obstacles, context);
+            NodeObstacles backward_filter(graph, obstacles, backward_context);
+            return BidirectionalKernelWithGoal(graph, start_id, goal_id, forward_filter, backward_filter,
+                                               forward_goal, backward_goal, context, backward_context, scheduler);
+        }
+        EdgeObstacles forward_filter(graph, obstacles, context);
+        EdgeObstacles backward_filter(graph, obstacles, backward_context);
+        return BidirectionalKernelWithGoal(graph, start_id, goal_id, forward_filter, backward_filter,
+                                           forward_goal, backward_goal, context, backward_context, scheduler);
+    }
 
-        while (!open_set.empty()) {
-            current_id = open_set.top().second;
-            open_set.pop();
+    bool PathfinderEngine::HierarchicalSearch(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        const std::vector<ObstacleZone>& obstacles,
+        bool block_crossing_edges,
+        SearchContext& context
+    ) {
+        const HierarchicalGraph& clusters = graph.base.hierarchical_graph;
+        if (!graph.IsValidId(start_id) || !graph.IsValidId(goal_id) || clusters.NodeCount() != graph.BaseCount()) {
+            return false;
+        }
 
-            if (current_id == goal_id) {
-                break; // Path found
+        // Clusters seen node by node: the ones the temporary points connect to and the ones an obstacle touches
+        // (their crossings may go through it); every other cluster is crossed from entrance to entrance
+        std::vector<uint8_t>& open_clusters = context.open_clusters;
+        open_clusters.assign(clusters.ClusterCount(), 0);
+        for (const auto& extra : graph.overlay_edges) {
+            if (!graph.IsTemporary(extra.first)) {
+                open_clusters[clusters.node_clusters[extra.first]] = 1;
             }
-
-            // Skip if this node is inside an obstacle zone (shouldn't happen if start was validated)
-            const Vec2f& current_pos = map_data.points[current_id].pos;
-            if (IsPointBlocked(current_pos, obstacles)) {
-                continue;
+            if (!graph.IsTemporary(extra.second.target_id)) {
+                open_clusters[clusters.node_clusters[extra.second.target_id]] = 1;
             }
+        }
+        for (const auto& obstacle : obstacles) {
+            clusters.ForEachClusterTouching(obstacle.center.x, obstacle.center.y, obstacle.radius, [&](int32_t cluster) {
+                open_clusters[cluster] = 1;
+            });
+        }
 
-            // Explore neighbors
-            if (current_id >= 0 && current_id < static_cast<int32_t>(map_data.visibility_graph.size())) {
-                const auto& edges = map_data.visibility_graph[current_id];
-
-                for (const auto& edge : edges) {
-                    int32_t neighbor_id = edge.target_id;
-                    if (neighbor_id < 0 || neighbor_id >= static_cast<int32_t>(map_data.points.size())) {
-                        continue;
-                    }
-
-                    // Skip neighbors that are inside obstacle zones
-                    const Vec2f& neighbor_pos = map_data.points[neighbor_id].pos;
-                    if (IsPointBlocked(neighbor_pos, obstacles)) {
-                        continue;
-                    }
-
-                    float new_cost = cost_so_far[current_id] + edge.distance;
-
-                    if (new_cost < cost_so_far[neighbor_id]) {
-                        cost_so_far[neighbor_id] = new_cost;
-                        came_from[neighbor_id] = current_id;
-
-                        // Calculate priority with heuristic
-                        float priority = new_cost;
-
-                        if (has_teleporters) {
-                            const Vec2f& goal_pos = map_data.points[goal_id].pos;
-
-                            float direct_dist = neighbor_pos.Distance(goal_pos);
-                            float tp_dist = TeleporterHeuristic(map_data, neighbor_pos, goal_pos);
-
-                            priority += std::min(direct_dist, tp_dist);
-                        } else {
-                            const Vec2f& goal_pos = map_data.points[goal_id].pos;
-                            priority += neighbor_pos.Distance(goal_pos);
-                        }
+        HeuristicGoal goal;
+        BeginHeuristic(graph, goal_id, goal);
+        if (!SearchKernelWithObstacles(graph, start_id, goal_id, ClusterEdges(graph, open_clusters), obstacles,
+                                       block_crossing_edges, goal, context)) {
+            return false;
+        }
 
-                        open_set.emplace(priority, neighbor_id);
-                    }
-                }
+        // Walk the search tree back, then expand every step across a closed cluster into the nodes it stands for
+        std::vector<int32_t>& hops = context.path_hops;
+        hops.clear();
+        for (int32_t id = goal_id; ; id = context.CameFrom(id)) {
+            hops.push_back(id);
+            if (id == start_id || static_cast<int32_t>(hops.size()) > graph.PointCount()) {
+                break;
             }
         }
+        if (hops.back() != start_id) {
+            return false;
+        }
+        std::reverse(hops.begin(), hops.end());
+
+        std::vector<int32_t>& nodes = context.path_nodes;
+        nodes.clear();
+        nodes.push_back(start_id);
+        for (size_t i = 1; i < hops.size(); ++i) {
+            const int32_t from = hops[i - 1];
+            const int32_t to = hops[i];
+            if (graph.IsTemporary(from) || graph.IsTemporary(to) ||
+                clusters.node_clusters[from] != clusters.node_clusters[to] || open_clusters[clusters.node_clusters[from]]) {
+                nodes.push_back(to);
+                continue;
+            }
 
-        if (current_id != goal_id) {
-            return {}; // No path found
+            // The step is a crossing of the cluster: insert the nodes stored with it
+            const int32_t entrance = clusters.entrance_indices[from];
+            uint32_t e = clusters.crossing_offsets[entrance];
+            while (e < clusters.crossing_offsets[entrance + 1] && clusters.crossing_targets[e] != to) {
+                ++e;
+            }
+            if (e == clusters.crossing_offsets[entrance + 1]) {
+                return false;
+            }
+            nodes.insert(nodes.end(), clusters.path_nodes.begin() + clusters.path_offsets[e],
+                         clusters.path_nodes.begin() + clusters.path_offsets[e + 1]);
+            nodes.push_back(to);
         }
 
-        return came_from;
+        return true;
     }
 
     std::vector<PathPointWithLayer> PathfinderEngine::ReconstructPath(
-        const MapData& map_data,
-        const std::vector<int32_t>& came_from,
+        const QueryGraph& graph,
+        const SearchContext& context,
         int32_t start_id,
         int32_t goal_id
     ) {
         std::vector<PathPointWithLayer> path;
         int32_t current = goal_id;
         int32_t count = 0;
-        const int32_t max_count = static_cast<int32_t>(map_data.points.size() * 2);
+        const int32_t max_count = graph.PointCount() * 2;
 
         while (current != start_id && count < max_count) {
-            if (current < 0 || current >= static_cast<int32_t>(map_data.points.size())) {
+            if (!graph.IsValidId(current)) {
                 break;
             }
 
-            path.emplace_back(map_data.points[current].pos, map_data.points[current].layer);
-            current = came_from[current];
+            path.emplace_back(graph.GetPoint(current).pos, graph.GetPoint(current).layer);
+            current = context.CameFrom(current);
             count++;
         }
 
@@ -527,34 +1495,34 @@ namespace Pathfinder {
         return path;
     }
 
-    std::vector<PathPointWithLayer> PathfinderEngine::ReconstructPathWithStart(
-        const MapData& map_data,
-        const std::vector<int32_t>& came_from,
+    void PathfinderEngine::ReconstructPathWithStart(
+        const QueryGraph& graph,
+        const SearchContext& context,
         int32_t start_id,
-        int32_t goal_id
+        int32_t goal_id,
+        std::vector<PathPointWithLayer>& out_path
     ) {
-        std::vector<PathPointWithLayer> path;
+        out_path.clear();
         int32_t current = goal_id;
         int32_t count = 0;
-        const int32_t max_count = static_cast<int32_t>(map_data.points.size() * 2);
+        const int32_t max_count = graph.PointCount() * 2;
 
         while (current != start_id && count < max_count) {
-            if (current < 0 || current >= static_cast<int32_t>(map_data.points.size())) {
+            if (!graph.IsValidId(current)) {
                 break;
             }
 
-            path.emplace_back(map_data.points[current].pos, map_data.points[current].layer);
-            current = came_from[current];
+            out_path.emplace_back(graph.GetPoint(current).pos, graph.GetPoint(current).layer);
+            current = context.CameFrom(current);
             count++;
         }
 
         // Include start_id in the path (for temporary points created at exact position)
-        if (current == start_id && start_id >= 0 && start_id < static_cast<int32_t>(map_data.points.size())) {
-            path.emplace_back(map_data.points[start_id].pos, map_data.points[start_id].layer);
+        if (current == start_id && graph.IsValidId(start_id)) {
+            out_path.emplace_back(graph.GetPoint(start_id).pos, graph.GetPoint(start_id).layer);
         }
 
-        std::reverse(path.begin(), path.end());
-        return path;
+        std::reverse(out_path.begin(), out_path.end());
     }
 
     int32_t PathfinderEngine::FindClosestPoint(
@@ -567,18 +1535,8 @@ namespace Pathfinder {
 
         // Simply find the closest point by distance
         // The A* algorithm will handle connectivity through the visibility graph
-        int32_t closest_id = -1;
-        float min_dist = std::numeric_limits<float>::infinity();
-
-        for (const auto& point : map_data.points) {
-            float dist = pos.SquaredDistance(point.pos);
-            if (dist < min_dist) {
-                min_dist = dist;
-                closest_id = point.id;
-            }
-        }
-
-        return closest_id;
+        return map_data.point_index.FindNearest(map_data.points, pos, std::numeric_limits<float>::infinity(),
+            [](int32_t) { return true; });
     }
 
     int32_t PathfinderEngine::FindClosestPointAvoidingObstacles(
@@ -590,25 +1548,10 @@ namespace Pathfinder {
             return -1;
         }
 
-        // Simply find the closest point by distance, avoiding obstacles
+        // Simply find the closest point by distance, skipping points inside obstacle zones
         // The A* algorithm will handle connectivity through the visibility graph
-        int32_t closest_id = -1;
-        float min_dist = std::numeric_limits<float>::infinity();
-
-        for (const auto& point : map_data.points) {
-            // Skip points that are inside obstacle zones
-            if (IsPointBlocked(point.pos, obstacles)) {
-                continue;
-            }
-
-            float dist = pos.SquaredDistance(point.pos);
-            if (dist < min_dist) {
-                min_dist = dist;
-                closest_id = point.id;
-            }
-        }
-
-        return closest_id;
+        return map_data.point_index.FindNearest(map_data.points, pos, std::numeric_limits<float>::infinity(),
+            [&](int32_t id) { return !IsPointBlocked(map_data.points[id].pos, obstacles); });
     }
 
     bool PathfinderEngine::IsPointBlocked(
@@ -623,167 +1566,107 @@ namespace Pathfinder {
         return false;
     }
 
-    float PathfinderEngine::Heuristic(
-        const MapData& map_data,
-        const Vec2f& from,
-        const Vec2f& to
-    ) {
-        return from.Distance(to);
-    }
-
-    float PathfinderEngine::TeleporterHeuristic(
-        const MapData& map_data,
-        const Vec2f& from,
-        const Vec2f& to
-    ) {
-        if (map_data.teleporters.empty()) {
-            return std::numeric_limits<float>::infinity();
-        }
-
-        // Find the teleporter closest to start
-        float closest_to_start_dist = std::numeric_limits<float>::infinity();
-        const Teleporter* closest_to_start = nullptr;
-
-        for (const auto& tp : map_data.teleporters) {
-            float dist = from.Distance(tp.enter);
-            if (tp.direction == 1) { // both-ways
-                dist = std::min(dist, from.Distance(tp.exit));
-            }
-
-            if (dist < closest_to_start_dist) {
-                closest_to_start_dist = dist;
-                closest_to_start = &tp;
-            }
-        }
-
-        // Find the teleporter closest to goal
-        float closest_to_goal_dist = std::numeric_limits<float>::infinity();
-        const Teleporter* closest_to_goal = nullptr;
+    void PathfinderEngine::BeginHeuristic(
+        const QueryGraph& graph,
+        int32_t goal_id,
+        HeuristicGoal& out_goal
+    ) const {
+        const MapData& map_data = graph.base;
+        out_goal.pos = graph.GetPoint(goal_id).pos;
 
-        for (const auto& tp : map_data.teleporters) {
-            float dist = to.Distance(tp.exit);
-            if (tp.direction == 1) { // both-ways
-                dist = std::min(dist, to.Distance(tp.enter));
-            }
+        // Whatever teleporters a path takes, it walks from the last exit to the goal
+        out_goal.teleporter_bound = kTeleporterCost + map_data.TeleporterExitDistance(out_goal.pos);
 
-            if (dist < closest_to_goal_dist) {
-                closest_to_goal_dist = dist;
-                closest_to_goal = &tp;
-            }
+        const LandmarkTable& landmarks = map_data.landmarks;
+        out_goal.use_landmarks = !landmarks.Empty() && landmarks.NodeCount() == graph.BaseCount();
+        if (!out_goal.use_landmarks) {
+            return;
         }
 
-        if (!closest_to_start || !closest_to_goal) {
-            return std::numeric_limits<float>::infinity();
+        landmarks.BeginTarget(out_goal.landmarks);
+        if (!graph.IsTemporary(goal_id)) {
+            landmarks.AddTargetEntry(out_goal.landmarks, goal_id, 0.0f);
+            return;
         }
 
-        // Calculate cost via teleporters
-        if (closest_to_start == closest_to_goal) {
-            return closest_to_start_dist + closest_to_start->exit.Distance(to);
+        // A temporary goal is only entered through overlay edges; a path coming back through the
+        // temporary start is never shorter than the one leaving it, so those edges are left out
+        for (const auto& extra : graph.overlay_edges) {
+            if (extra.second.target_id == goal_id && !graph.IsTemporary(extra.first)) {
+                landmarks.AddTargetEntry(out_goal.landmarks, extra.first, extra.second.distance);
+            }
         }
-
-        float tp_travel_cost = closest_to_start->exit.Distance(closest_to_goal->exit);
-        return closest_to_start_dist + tp_travel_cost + closest_to_goal_dist;
     }
 
     std::vector<PathPointWithLayer> PathfinderEngine::SimplifyPath(
         const std::vector<PathPointWithLayer>& path,
         float min_spacing
     ) {
+        std::vector<PathPointWithLayer> simplified = path;
+        SimplifyPathInPlace(simplified, min_spacing);
+        return simplified;
+    }
+
+    void PathfinderEngine::SimplifyPathInPlace(std::vector<PathPointWithLayer>& path, float min_spacing) {
         if (path.size() <= 2 || min_spacing <= 0.0f) {
-            return path;
+            return;
         }
 
-        std::vector<PathPointWithLayer> simplified;
-        simplified.push_back(path[0]); // Always include the first point
-
-        PathPointWithLayer last_added = path[0];
-
+        // Kept points are compacted to the front; the first point always stays
+        size_t kept = 1;
         for (size_t i = 1; i < path.size() - 1; ++i) {
-            float dist = last_added.pos.Distance(path[i].pos);
+            float dist = path[kept - 1].pos.Distance(path[i].pos);
             // Keep point if distance is enough OR if layer changes (important for bridges!)
-            if (dist >= min_spacing || path[i].layer != last_added.layer) {
-                simplified.push_back(path[i]);
-                last_added = path[i];
+            if (dist >= min_spacing || path[i].layer != path[kept - 1].layer) {
+                path[kept++] = path[i];
             }
         }
 
-        simplified.push_back(path.back()); // Always include the last point
-
-        return simplified;
+        path[kept++] = path.back(); // Always include the last point
+        path.resize(kept);
     }
 
     bool PathfinderEngine::IsMapLoaded(int32_t map_id) const {
-        return m_loaded_maps.find(map_id) != m_loaded_maps.end();
+        return m_map_cache.Contains(map_id);
     }
 
     std::vector<int32_t> PathfinderEngine::GetLoadedMapIds() const {
-        std::vector<int32_t> ids;
-        ids.reserve(m_loaded_maps.size());
-
-        for (const auto& pair : m_loaded_maps) {
-            ids.push_back(pair.first);
-        }
-
-        return ids;
+        return m_map_cache.GetMapIds();
     }
 
     bool PathfinderEngine::GetMapStatistics(int32_t map_id, MapStatistics& out_stats) const {
-        auto it = m_loaded_maps.find(map_id);
-        if (it == m_loaded_maps.end()) {
+        std::shared_ptr<const MapData> map_data = m_map_cache.Peek(map_id);
+        if (!map_data) {
             return false;
         }
 
-        out_stats = it->second.stats;
+        out_stats = map_data->stats;
         return true;
     }
 
     int32_t PathfinderEngine::CreateTemporaryPoint(
-        MapData& map_data,
+        QueryGraph& graph,
         const Vec2f& pos
     ) {
+        const MapData& map_data = graph.base;
+
         // First, check if the position is inside a trapezoid
         const Trapezoid* trap = map_data.FindTrapezoidContaining(pos);
         if (trap) {
             // Create a new point with a unique ID on the trapezoid's layer
-            int32_t new_id = static_cast<int32_t>(map_data.points.size());
-            map_data.points.emplace_back(new_id, pos, trap->layer);
-
-            // Ensure the visibility graph has space for this point
-            if (map_data.visibility_graph.size() <= static_cast<size_t>(new_id)) {
-                map_data.visibility_graph.resize(new_id + 1);
-            }
-
-            return new_id;
+            return graph.AddPoint(pos, trap->layer);
         }
 
         // Not on a trapezoid - check if there's a nearby point on a layer (within range)
         // This handles cases where the position is on a layer but not inside a trapezoid
         const float layer_range = 500.0f; // Max distance to consider as "on a layer"
-        const float layer_range_squared = layer_range * layer_range;
 
-        int32_t closest_id = -1;
-        float min_dist_sq = std::numeric_limits<float>::infinity();
-
-        for (const auto& point : map_data.points) {
-            float dist_sq = pos.SquaredDistance(point.pos);
-            if (dist_sq < min_dist_sq && dist_sq < layer_range_squared) {
-                min_dist_sq = dist_sq;
-                closest_id = point.id;
-            }
-        }
+        int32_t closest_id = map_data.point_index.FindNearest(map_data.points, pos, layer_range,
+            [](int32_t) { return true; });
 
         if (closest_id >= 0) {
             // Found a nearby point - create temporary point on the same layer
-            int32_t layer = map_data.points[closest_id].layer;
-            int32_t new_id = static_cast<int32_t>(map_data.points.size());
-            map_data.points.emplace_back(new_id, pos, layer);
-
-            // Ensure the visibility graph has space for this point
-            if (map_data.visibility_graph.size() <= static_cast<size_t>(new_id)) {
-                map_data.visibility_graph.resize(new_id + 1);
-            }
-
-            return new_id;
+            return graph.AddPoint(pos, map_data.points[closest_id].layer);
         }
 
         // Not on a trapezoid and not near any layer point
@@ -791,140 +1674,77 @@ namespace Pathfinder {
     }
 
     int32_t PathfinderEngine::CreateTemporaryPointForced(
-        MapData& map_data,
+        QueryGraph& graph,
         const Vec2f& pos
     ) {
         // Create a temporary point at this position regardless of trapezoid or layer
         // Find the closest existing point to determine the layer
-        int32_t closest_id = FindClosestPoint(map_data, pos);
+        int32_t closest_id = FindClosestPoint(graph.base, pos);
         int32_t layer = 0;
 
-        if (closest_id >= 0 && closest_id < static_cast<int32_t>(map_data.points.size())) {
-            layer = map_data.points[closest_id].layer;
+        if (closest_id >= 0 && closest_id < graph.BaseCount()) {
+            layer = graph.base.points[closest_id].layer;
         }
 
         // Create a new point with a unique ID
-        int32_t new_id = static_cast<int32_t>(map_data.points.size());
-        map_data.points.emplace_back(new_id, pos, layer);
-
-        // Ensure the visibility graph has space for this point
-        if (map_data.visibility_graph.size() <= static_cast<size_t>(new_id)) {
-            map_data.visibility_graph.resize(new_id + 1);
-        }
-
-        return new_id;
+        return graph.AddPoint(pos, layer);
     }
 
     int32_t PathfinderEngine::CreateTemporaryPointWithLayer(
-        MapData& map_data,
+        QueryGraph& graph,
         const Vec2f& pos,
         int32_t layer
     ) {
         // Create a temporary point at this position with the specified layer
-        int32_t new_id = static_cast<int32_t>(map_data.points.size());
-        map_data.points.emplace_back(new_id, pos, layer);
-
-        // Ensure the visibility graph has space for this point
-        if (map_data.visibility_graph.size() <= static_cast<size_t>(new_id)) {
-            map_data.visibility_graph.resize(new_id + 1);
-        }
-
-        return new_id;
+        return graph.AddPoint(pos, layer);
     }
 
     void PathfinderEngine::InsertPointIntoVisGraph(
-        MapData& map_data,
+        QueryGraph& graph,
         int32_t point_id,
         int32_t max_connections,
         float max_range,
         bool allow_cross_layer
     ) {
-        if (point_id < 0 || point_id >= static_cast<int32_t>(map_data.points.size())) {
+        if (!graph.IsValidId(point_id)) {
             return;
         }
 
-        const Point& point = map_data.points[point_id];
+        const Point point = graph.GetPoint(point_id);
         const float max_range_squared = max_range * max_range;
-
-        // Collect all nearby points with their distances
-        struct Connection {
-            int32_t id;
-            float distance;
-        };
-        std::vector<Connection> connections;
-
-        for (size_t i = 0; i < map_data.points.size(); ++i) {
-            if (static_cast<int32_t>(i) == point_id) continue;
-
-            const Point& other = map_data.points[i];
-
-            // Skip points on different layers unless cross-layer connections are allowed
+        const std::vector<Point>& base_points = graph.base.points;
+
+        // Nearest base points within range (on the same layer unless cross-layer connections are allowed)
+        // This allows reaching isolated points that have no existing connections
+        std::vector<PointNeighbor>& connections = graph.neighbor_scratch;
+        graph.base.point_index.FindKNearest(base_points, point.pos, static_cast<size_t>(max_connections), max_range,
+            [&](int32_t id) { return allow_cross_layer || base_points[id].layer == point.layer; },
+            connections);
+
+        // Temporary points already inserted by this query are not in the index
+        for (const auto& other : graph.temp_points) {
+            if (other.id == point_id) continue;
             if (!allow_cross_layer && other.layer != point.layer) continue;
 
             float dist_sq = point.pos.SquaredDistance(other.pos);
             if (dist_sq < max_range_squared) {
-                // Connect to all nearby points
-                // This allows reaching isolated points that have no existing connections
-                connections.push_back({static_cast<int32_t>(i), std::sqrt(dist_sq)});
+                connections.push_back({other.id, dist_sq});
             }
         }
 
-        // Sort by distance and keep only the closest connections
-        std::sort(connections.begin(), connections.end(),
-            [](const Connection& a, const Connection& b) { return a.distance < b.distance; });
-
+        // Keep only the closest connections
+        std::sort(connections.begin(), connections.end());
         if (connections.size() > static_cast<size_t>(max_connections)) {
             connections.resize(max_connections);
         }
 
-        // Ensure visibility graph is large enough for the new point
-        if (static_cast<size_t>(point_id) >= map_data.visibility_graph.size()) {
-            map_data.visibility_graph.resize(point_id + 1);
-        }
-
         // Add edges from the new point to nearby points
         for (const auto& conn : connections) {
-            // Verify connection target is valid
-            if (conn.id < 0 || conn.id >= static_cast<int32_t>(map_data.points.size())) {
-                continue;
-            }
-
-            map_data.visibility_graph[point_id].emplace_back(conn.id, conn.distance);
+            float distance = std::sqrt(conn.distance_sq);
+            graph.AddEdge(point_id, conn.id, distance);
 
             // Add reverse edge (bidirectional)
-            if (conn.id >= 0 && conn.id < static_cast<int32_t>(map_data.visibility_graph.size())) {
-                map_data.visibility_graph[conn.id].emplace_back(point_id, conn.distance);
-            }
-        }
-    }
-
-    void PathfinderEngine::RemoveTemporaryPoints(
-        MapData& map_data,
-        size_t original_point_count,
-        size_t original_visgraph_size
-    ) {
-        // Remove edges added to existing points that reference temporary points
-        // IMPORTANT: We must iterate through ALL original points, not just up to original_visgraph_size
-        // because InsertPointIntoVisGraph adds bidirectional edges to existing points
-        for (size_t i = 0; i < original_point_count && i < map_data.visibility_graph.size(); ++i) {
-            auto& edges = map_data.visibility_graph[i];
-            edges.erase(
-                std::remove_if(edges.begin(), edges.end(),
-                    [original_point_count](const VisibilityEdge& edge) {
-                        return edge.target_id >= static_cast<int32_t>(original_point_count);
-                    }),
-                edges.end()
-            );
-        }
-
-        // Remove temporary vis_graph entries
-        if (map_data.visibility_graph.size() > original_visgraph_size) {
-            map_data.visibility_graph.resize(original_visgraph_size);
-        }
-
-        // Remove temporary points from the points array
-        if (map_data.points.size() > original_point_count) {
-            map_data.points.resize(original_point_count);
+            graph.AddEdge(conn.id, point_id, distance);
         }
     }
 
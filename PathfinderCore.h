@@ -1,10 +1,25 @@
 #pragma once
 
+#include "MapCache.h"
+#include "ComponentIndex.h"
+#include "ContractionHierarchy.h"
+#include "HierarchicalGraph.h"
+#include "Landmarks.h"
+#include "OpenSet.h"
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <stdexcept>
 #include <cstdint>
 #include <cmath>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <atomic>
 
 namespace Pathfinder {
 
@@ -64,15 +79,60 @@ namespace Pathfinder {
     struct VisibilityEdge {
         int32_t target_id;      // Target point ID
         float distance;         // Distance to target point
-        std::vector<uint32_t> blocking_layers; // Layers that block this path
 
         VisibilityEdge() : target_id(-1), distance(0.0f) {}
         VisibilityEdge(int32_t id, float dist) : target_id(id), distance(dist) {}
-        VisibilityEdge(int32_t id, float dist, const std::vector<uint32_t>& layers)
-            : target_id(id), distance(dist), blocking_layers(layers) {}
     };
 
+    // Visibility graph stored in compressed sparse row (CSR) layout
+    // The edges leaving point i are [offsets[i], offsets[i + 1]) in targets/distances
+    struct VisibilityGraph {
+        std::vector<uint32_t> offsets;      // One entry per point, plus a final end offset
+        std::vector<int32_t> targets;       // Target point ID of each edge
+        std::vector<float> distances;       // Distance of each edge
+
+        // Blocking layers are rare, so they live in a side table instead of on every edge
+        std::vector<uint32_t> blocking_edges;   // Sorted indices of the edges that have blocking layers
+        std::vector<uint32_t> blocking_offsets; // Range of each blocking edge in blocking_layers (size = blocking_edges + 1)
+        std::vector<uint32_t> blocking_layers;  // Layers that block the path, flattened
+
+        int32_t NodeCount() const {
+            return offsets.empty() ? 0 : static_cast<int32_t>(offsets.size() - 1);
+        }
+
+        size_t EdgeCount() const {
+            return targets.size();
+        }
+
+        bool Empty() const {
+            return NodeCount() == 0;
+        }
+
+        // Returns the layers blocking an edge (nullptr and count = 0 if none)
+        const uint32_t* GetBlockingLayers(uint32_t edge_index, size_t& out_count) const {
+            out_count = 0;
+            auto it = std::lower_bound(blocking_edges.begin(), blocking_edges.end(), edge_index);
+            if (it == blocking_edges.end() || *it != edge_index) {
+                return nullptr;
+            }
+
+            size_t slot = static_cast<size_t>(it - blocking_edges.begin());
+            out_count = blocking_offsets[slot + 1] - blocking_offsets[slot];
+            return blocking_layers.data() + blocking_offsets[slot];
+        }
+
+        // Whether every edge has a reverse edge of the same distance
+        bool IsSymmetric() const;
+
+        // Fills out_lengths with the distance of the longest edge leaving each node
+        void MaxEdgeLengths(std::vector<float>& out_lengths) const;
+    };
+
+    // Graph cost of a teleporter hop (the jump itself takes no walking)
+    constexpr float kTeleporterCost = 0.0f;
+
     // Structure for a teleporter
+    // Both ends are graph points, linked by edges of kTeleporterCost (see ParseMapJsonStreaming)
     struct Teleporter {
         Vec2f enter;    // Entry point
         Vec2f exit;     // Exit point
@@ -134,6 +194,53 @@ namespace Pathfinder {
             : enter_pos(enter_x, enter_y), dest_map_id(map_id), dest_pos(dest_x, dest_y) {}
     };
 
+    // How a map is left
+    enum class TravelKind : int32_t {
+        None = 0,       // Not a transition (end of a route)
+        Portal = 1,     // Walk into a travel portal
+        Npc = 2,        // Talk to an NPC and send its dialogs
+        Enter = 3       // Press Enter at a position
+    };
+
+    // Any way out of a map with a known destination (see MapData::GetTransitions)
+    struct MapTransition {
+        TravelKind kind;
+        Vec2f position;         // Where the transition is taken
+        int32_t dest_map_id;
+        Vec2f dest_pos;         // Arrival position on the destination map
+        int32_t dialog_ids[5];  // NPC dialog IDs (Npc only, 0 otherwise)
+
+        MapTransition() : kind(TravelKind::None), position(), dest_map_id(0), dest_pos() {
+            for (int i = 0; i < 5; ++i) dialog_ids[i] = 0;
+        }
+    };
+
+    // Walking costs from the points where other maps lead into a map to each of its transitions
+    // Needs every map to know the arrivals, so it is only computed when baking (GWMapBaker)
+    struct TravelCostTable {
+        std::vector<Vec2f> arrivals;    // Distinct dest_pos of the transitions leading to this map
+        std::vector<float> costs;       // arrivals x transitions, row-major (infinity = unreachable)
+
+        bool Empty() const {
+            return arrivals.empty();
+        }
+
+        // Row of an arrival position (exact match, -1 if unknown)
+        int32_t FindArrival(const Vec2f& pos) const {
+            for (size_t i = 0; i < arrivals.size(); ++i) {
+                if (arrivals[i].x == pos.x && arrivals[i].y == pos.y) {
+                    return static_cast<int32_t>(i);
+                }
+            }
+            return -1;
+        }
+
+        void Clear() {
+            arrivals.clear();
+            costs.clear();
+        }
+    };
+
     // Structure for map statistics
     struct MapStatistics {
         int32_t trapezoid_count;
@@ -142,9 +249,10 @@ namespace Pathfinder {
         int32_t travel_portal_count;
         int32_t npc_travel_count;
         int32_t enter_travel_count;
+        int32_t unconnected_teleport_count;    // Teleporters with an end that is not a graph point (cannot be taken)
 
         MapStatistics() : trapezoid_count(0), point_count(0), teleport_count(0), travel_portal_count(0),
-                          npc_travel_count(0), enter_travel_count(0) {}
+                          npc_travel_count(0), enter_travel_count(0), unconnected_teleport_count(0) {}
     };
 
     // Structure for an obstacle zone (circular area to avoid during pathfinding)
@@ -206,61 +314,786 @@ namespace Pathfinder {
     };
 
 
+    // Uniform grid bucketing item indices by bounding box
+    // Buckets are stored in CSR layout: the items of cell c are [cell_offsets[c], cell_offsets[c + 1])
+    // Items inside a bucket keep their original (increasing) index order
+    struct UniformGrid {
+        Vec2f origin;           // Lower corner of the grid
+        float cell_size;
+        float inv_cell_size;
+        int32_t cols;
+        int32_t rows;
+        std::vector<uint32_t> cell_offsets;
+        std::vector<int32_t> items;
+
+        UniformGrid() : origin(), cell_size(0), inv_cell_size(0), cols(0), rows(0) {}
+
+        bool Empty() const {
+            return cell_offsets.empty();
+        }
+
+        // Builds the grid from one bounding box per item
+        void Build(const std::vector<Vec2f>& box_min, const std::vector<Vec2f>& box_max, float target_cell_size);
+
+        // Cell coordinates of a position (clamped to the grid)
+        int32_t CellX(float x) const {
+            int32_t cx = static_cast<int32_t>(std::floor((x - origin.x) * inv_cell_size));
+            return std::min(std::max(cx, 0), cols - 1);
+        }
+
+        int32_t CellY(float y) const {
+            int32_t cy = static_cast<int32_t>(std::floor((y - origin.y) * inv_cell_size));
+            return std::min(std::max(cy, 0), rows - 1);
+        }
+
+        int32_t CellIndex(int32_t cx, int32_t cy) const {
+            return cy * cols + cx;
+        }
+    };
+
+    // Spatial index over the trapezoids of a map (built once at load time)
+    // The bounding boxes of the bucketed trapezoids are copied in grid order as structure-of-arrays
+    // (slot i is grid.items[i]) so that a cell is filtered several trapezoids at a time
+    struct TrapezoidIndex {
+        UniformGrid grid;
+        std::vector<float> box_min_x;   // Bounding box of each grid slot, padded with empty slots
+        std::vector<float> box_min_y;
+        std::vector<float> box_max_x;
+        std::vector<float> box_max_y;
+
+        void Build(const std::vector<Trapezoid>& trapezoids);
+
+        bool Empty() const {
+            return grid.Empty();
+        }
+
+        // Returns the index of the first trapezoid (in map order) containing pos, or -1 if none
+        // layer >= 0 restricts the lookup to the trapezoids of that layer
+        int32_t FindContaining(const std::vector<Trapezoid>& trapezoids, const Vec2f& pos, int32_t layer = -1) const;
+    };
+
+    // Obstacle zones of a single query bucketed in a uniform grid (rebuilt per query, storage reused)
+    struct ObstacleIndex {
+        UniformGrid grid;
+        std::vector<Vec2f> box_min;     // Bounding box of each obstacle
+        std::vector<Vec2f> box_max;
+
+        // Obstacles kept by SelectNear as structure-of-arrays for the vectorized segment test,
+        // padded to a multiple of 8 with circles that never intersect
+        std::vector<float> near_x;
+        std::vector<float> near_y;
+        std::vector<float> near_radius_sq;
+
+        // Stamp of the last SelectNear call that kept each obstacle (obstacles span several cells)
+        std::vector<uint32_t> selected_stamps;
+        uint32_t selection_stamp;
+
+        ObstacleIndex() : selection_stamp(0) {}
+
+        void Build(const std::vector<ObstacleZone>& obstacles);
+
+        // Keeps the obstacles that a segment starting at pos and no longer than reach can touch,
+        // looking only at the grid cells within reach of pos
+        void SelectNear(const std::vector<ObstacleZone>& obstacles, const Vec2f& pos, float reach);
+
+        // Whether the last SelectNear call kept any obstacle (most nodes have none within reach)
+        bool HasNear() const {
+            return !near_x.empty();
+        }
+
+        // Checks whether the segment from -> to crosses or touches one of the obstacles kept by the
+        // last SelectNear call (SSE2 or AVX2 when available)
+        bool IntersectsSegment(const Vec2f& from, const Vec2f& to) const;
+
+        // Checks whether a position is inside any of the obstacles the index was built from
+        bool Contains(const std::vector<ObstacleZone>& obstacles, const Vec2f& pos) const {
+            if (grid.Empty()) {
+                return false;
+            }
+
+            // Positions off the grid are clamped to its border cells, reject them first
+            if (pos.x < grid.origin.x || pos.y < grid.origin.y ||
+                pos.x > grid.origin.x + grid.cols * grid.cell_size || pos.y > grid.origin.y + grid.rows * grid.cell_size) {
+                return false;
+            }
+
+            const int32_t cell = grid.CellIndex(grid.CellX(pos.x), grid.CellY(pos.y));
+            const uint32_t end = grid.cell_offsets[cell + 1];
+            for (uint32_t i = grid.cell_offsets[cell]; i < end; ++i) {
+                if (obstacles[grid.items[i]].Contains(pos)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    // Result entry of a point index query
+    struct PointNeighbor {
+        int32_t id;             // Point ID
+        float distance_sq;      // Squared distance to the query position
+
+        bool operator<(const PointNeighbor& other) const {
+            return distance_sq < other.distance_sq || (distance_sq == other.distance_sq && id < other.id);
+        }
+    };
+
+    // Spatial index over the graph points of a map (built once at load time)
+    // Queries visit grid cells in rings of increasing distance and stop as soon as no closer
+    // point can exist. The filter is a bool(int32_t point_id) predicate (layer, obstacles, ...)
+    // Ties are broken by the lowest point ID, like a linear scan would
+    struct PointIndex {
+        UniformGrid grid;
+
+        void Build(const std::vector<Point>& points);
+
+        bool Empty() const {
+            return grid.Empty();
+        }
+
+        // Closest accepted point strictly within max_range, or -1
+        template <typename Filter>
+        int32_t FindNearest(const std::vector<Point>& points, const Vec2f& pos, float max_range, Filter&& filter) const {
+            PointNeighbor best{-1, max_range * max_range};
+            VisitRings(pos, [&](int32_t point_id) {
+                float dist_sq = pos.SquaredDistance(points[point_id].pos);
+                PointNeighbor candidate{point_id, dist_sq};
+                if ((best.id < 0 ? dist_sq < best.distance_sq : candidate < best) && filter(point_id)) {
+                    best = candidate;
+                }
+            }, [&]() { return best.distance_sq; });
+            return best.id;
+        }
+
+        // Up to k closest accepted points strictly within max_range, sorted by distance
+        template <typename Filter>
+        void FindKNearest(const std::vector<Point>& points, const Vec2f& pos, size_t k, float max_range,
+                          Filter&& filter, std::vector<PointNeighbor>& out) const {
+            out.clear();
+            if (k == 0) {
+                return;
+            }
+
+            const float max_range_sq = max_range * max_range;
+            VisitRings(pos, [&](int32_t point_id) {
+                float dist_sq = pos.SquaredDistance(points[point_id].pos);
+                if (dist_sq >= max_range_sq) {
+                    return;
+                }
+
+                PointNeighbor candidate{point_id, dist_sq};
+                if (out.size() == k && !(candidate < out.back())) {
+                    return;
+                }
+                if (!filter(point_id)) {
+                    return;
+                }
+
+                // Sorted insertion, k is small
+                if (out.size() == k) {
+                    out.pop_back();
+                }
+                out.insert(std::upper_bound(out.begin(), out.end(), candidate), candidate);
+            }, [&]() { return out.size() == k ? out.back().distance_sq : max_range_sq; });
+        }
+
+        // All accepted points strictly within radius, sorted by distance
+        template <typename Filter>
+        void FindWithinRadius(const std::vector<Point>& points, const Vec2f& pos, float radius,
+                              Filter&& filter, std::vector<PointNeighbor>& out) const {
+            out.clear();
+            const float radius_sq = radius * radius;
+            VisitRings(pos, [&](int32_t point_id) {
+                float dist_sq = pos.SquaredDistance(points[point_id].pos);
+                if (dist_sq < radius_sq && filter(point_id)) {
+                    out.push_back({point_id, dist_sq});
+                }
+            }, [&]() { return radius_sq; });
+            std::sort(out.begin(), out.end());
+        }
+
+    private:
+        // Calls visit(point_id) for every point of the cells around pos, ring by ring,
+        // until the distance to the next ring exceeds sqrt(limit_sq())
+        template <typename Visit, typename Limit>
+        void VisitRings(const Vec2f& pos, Visit&& visit, Limit&& limit_sq) const {
+            if (grid.Empty()) {
+                return;
+            }
+
+            const int32_t cx = grid.CellX(pos.x);
+            const int32_t cy = grid.CellY(pos.y);
+            const int32_t max_ring = std::max(std::max(cx, grid.cols - 1 - cx), std::max(cy, grid.rows - 1 - cy));
+
+            auto visit_cell = [&](int32_t x, int32_t y) {
+                if (x < 0 || y < 0 || x >= grid.cols || y >= grid.rows) {
+                    return;
+                }
+                const int32_t cell = grid.CellIndex(x, y);
+                const uint32_t end = grid.cell_offsets[cell + 1];
+                for (uint32_t i = grid.cell_offsets[cell]; i < end; ++i) {
+                    visit(grid.items[i]);
+                }
+            };
+
+            for (int32_t ring = 0; ring <= max_ring; ++ring) {
+                if (ring > 0) {
+                    // Lower bound of the distance from pos to any cell of this ring
+                    const float left = grid.origin.x + (cx - ring + 1) * grid.cell_size;
+                    const float right = grid.origin.x + (cx + ring) * grid.cell_size;
+                    const float bottom = grid.origin.y + (cy - ring + 1) * grid.cell_size;
+                    const float top = grid.origin.y + (cy + ring) * grid.cell_size;
+                    float bound = 0.0f;
+                    if (pos.x >= left && pos.x <= right && pos.y >= bottom && pos.y <= top) {
+                        bound = std::min(std::min(pos.x - left, right - pos.x), std::min(pos.y - bottom, top - pos.y));
+                    }
+                    if (bound * bound > limit_sq()) {
+                        break;
+                    }
+                }
+
+                if (ring == 0) {
+                    visit_cell(cx, cy);
+                    continue;
+                }
+
+                for (int32_t x = cx - ring; x <= cx + ring; ++x) {
+                    visit_cell(x, cy - ring);
+                    visit_cell(x, cy + ring);
+                }
+                for (int32_t y = cy - ring + 1; y <= cy + ring - 1; ++y) {
+                    visit_cell(cx - ring, y);
+                    visit_cell(cx + ring, y);
+                }
+            }
+        }
+    };
+
     // Map data structure
     struct MapData {
         int32_t map_id;
         std::vector<Point> points;
-        std::vector<std::vector<VisibilityEdge>> visibility_graph;
+        VisibilityGraph visibility_graph;   // Edges between points (CSR, one row per point)
         std::vector<Trapezoid> trapezoids;  // Walkable areas
         std::vector<Teleporter> teleporters;
         std::vector<TravelPortal> travel_portals;
         std::vector<NpcTravel> npc_travels;
         std::vector<EnterTravel> enter_travels;
         MapStatistics stats;
-
-        MapData() : map_id(-1) {}
+        TrapezoidIndex trapezoid_index;     // Point location over trapezoids
+        PointIndex point_index;             // Nearest-neighbour queries over points
+        std::vector<float> teleporter_entry_distances; // Straight-line distance from each point to the nearest teleporter entry (empty without teleporters)
+        std::vector<float> max_edge_lengths; // Longest edge leaving each point (obstacle edge test)
+        ComponentIndex components;          // Connected components of the visibility graph (unreachable goals)
+        ContractionHierarchy contraction_hierarchy; // Optional (baked or built at load), used by queries without obstacles
+        LandmarkTable landmarks;            // ALT heuristic tables (baked or built at load)
+        HierarchicalGraph hierarchical_graph; // Optional cluster level (built at load), for the queries the hierarchy above cannot answer
+        TravelCostTable travel_costs;       // Baked only, used by world routes (see WorldGraph.h)
+        bool symmetric_graph;               // Every edge has its reverse (no one-way teleporter), bidirectional search applies
+
+        MapData() : map_id(-1), symmetric_graph(false) {}
 
         bool IsValid() const {
-            return map_id > 0 && !points.empty() && !visibility_graph.empty();
+            return map_id > 0 && !points.empty() && !visibility_graph.Empty();
         }
 
+        // Builds the spatial indexes, the teleporter table, the connected components, the symmetry flag
+        // and the longest edge of each point (must be called once the geometry is loaded)
+        void BuildSpatialIndex() {
+            trapezoid_index.Build(trapezoids);
+            point_index.Build(points);
+
+            components.Clear();
+            if (visibility_graph.NodeCount() == static_cast<int32_t>(points.size())) {
+                components.Build(visibility_graph.NodeCount(), visibility_graph.offsets.data(), visibility_graph.targets.data());
+            }
+            symmetric_graph = visibility_graph.IsSymmetric();
+            visibility_graph.MaxEdgeLengths(max_edge_lengths);
+
+            teleporter_entry_distances.clear();
+            if (!teleporters.empty()) {
+                teleporter_entry_distances.reserve(points.size());
+                for (const auto& point : points) {
+                    teleporter_entry_distances.push_back(TeleporterEntryDistance(point.pos));
+                }
+            }
+        }
+
+        // Straight-line distance to the nearest end a teleporter can be taken from (infinity without teleporters)
+        float TeleporterEntryDistance(const Vec2f& pos) const {
+            float distance_sq = std::numeric_limits<float>::infinity();
+            for (const auto& tp : teleporters) {
+                distance_sq = std::min(distance_sq, pos.SquaredDistance(tp.enter));
+                if (tp.direction == 1) { // both-ways
+                    distance_sq = std::min(distance_sq, pos.SquaredDistance(tp.exit));
+                }
+            }
+            return std::sqrt(distance_sq);
+        }
+
+        // Straight-line distance to the nearest end a teleporter can leave at (infinity without teleporters)
+        float TeleporterExitDistance(const Vec2f& pos) const {
+            float distance_sq = std::numeric_limits<float>::infinity();
+            for (const auto& tp : teleporters) {
+                distance_sq = std::min(distance_sq, pos.SquaredDistance(tp.exit));
+                if (tp.direction == 1) { // both-ways
+                    distance_sq = std::min(distance_sq, pos.SquaredDistance(tp.enter));
+                }
+            }
+            return std::sqrt(distance_sq);
+        }
+
+        // Whether a step between two path points is a teleporter jump (ends matched within 1 unit, as
+        // when the teleporters are connected), which costs kTeleporterCost instead of its length
+        bool IsTeleporterHop(const Vec2f& from, const Vec2f& to) const {
+            for (const auto& tp : teleporters) {
+                if (from.SquaredDistance(tp.enter) < 1.0f && to.SquaredDistance(tp.exit) < 1.0f) {
+                    return true;
+                }
+                if (tp.direction == 1 && from.SquaredDistance(tp.exit) < 1.0f && to.SquaredDistance(tp.enter) < 1.0f) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Approximate heap size of the map in bytes (counted against the map cache budget)
+        size_t MemoryUsage() const;
+
+        // Contracts the visibility graph (slow: up to a few seconds on the largest maps)
+        void BuildContractionHierarchy();
+
+        // Chooses the landmarks and computes their distance tables (one Dijkstra per landmark)
+        void BuildLandmarks();
+
+        // Partitions the points into clusters and computes the paths across each cluster (up to ~100 ms)
+        void BuildHierarchicalGraph();
+
+        // Travel portal connections, NPC and enter travel with a known destination, in that order
+        // (the column order of travel_costs)
+        std::vector<MapTransition> GetTransitions() const;
+
         // Find the trapezoid containing a point (returns nullptr if not found)
-        const Trapezoid* FindTrapezoidContaining(const Vec2f& pos) const {
+        // layer >= 0 only considers trapezoids on that layer
+        const Trapezoid* FindTrapezoidContaining(const Vec2f& pos, int32_t layer = -1) const {
+            if (!trapezoid_index.Empty()) {
+                int32_t index = trapezoid_index.FindContaining(trapezoids, pos, layer);
+                return index >= 0 ? &trapezoids[index] : nullptr;
+            }
+
             for (const auto& trap : trapezoids) {
-                if (trap.ContainsPoint(pos)) {
+                if ((layer < 0 || trap.layer == layer) && trap.ContainsPoint(pos)) {
                     return &trap;
                 }
             }
             return nullptr;
         }
+
+        // Locates count positions (xy = x0, y0, x1, y1, ...): ID and layer of the trapezoid containing
+        // each one, -1 for both when the position is not walkable
+        // Returns the number of walkable positions
+        int32_t LocatePoints(const float* xy, int32_t count, int32_t* out_trapezoid_ids, int32_t* out_layers) const;
+    };
+
+    // Reusable state of an A* search, cached per thread and kept between queries
+    // Per-node entries are only valid when their stamp matches the current generation,
+    // so starting a search is O(1) instead of refilling arrays sized to the whole map
+    class SearchContext {
+    public:
+        SearchContext() : m_generation(0) {}
+
+        // Starts a new search over node_count nodes (buffers only grow, never shrink)
+        void Begin(int32_t node_count) {
+            if (m_stamps.size() < static_cast<size_t>(node_count)) {
+                m_stamps.resize(node_count, 0);
+                m_costs.resize(node_count);
+                m_came_from.resize(node_count);
+            }
+
+            if (++m_generation == 0) {
+                // Stamp wrap-around: invalidate every entry once
+                std::fill(m_stamps.begin(), m_stamps.end(), 0u);
+                m_generation = 1;
+            }
+
+            open_set.Begin(node_count);
+        }
+
+        // Cost from the start (infinity if not reached by the current search)
+        float Cost(int32_t id) const {
+            return m_stamps[id] == m_generation ? m_costs[id] : std::numeric_limits<float>::infinity();
+        }
+
+        // Predecessor on the best known path (-1 if not reached by the current search)
+        int32_t CameFrom(int32_t id) const {
+            return m_stamps[id] == m_generation ? m_came_from[id] : -1;
+        }
+
+        void Update(int32_t id, float cost, int32_t came_from) {
+            m_stamps[id] = m_generation;
+            m_costs[id] = cost;
+            m_came_from[id] = came_from;
+        }
+
+        // Starts the blocked-node flags of a query with obstacles (two bits per node, cleared in bulk)
+        void BeginBlockedNodes(int32_t node_count) {
+            const size_t words = (static_cast<size_t>(node_count) + 63) / 64;
+            m_blocked_known.assign(words, 0);
+            m_blocked.assign(words, 0);
+        }
+
+        // Whether a node is blocked; test(id) only runs the first time a node is asked about
+        template <typename Test>
+        bool IsBlocked(int32_t id, Test&& test) {
+            const size_t word = static_cast<size_t>(id) >> 6;
+            const uint64_t bit = uint64_t(1) << (id & 63);
+            if (!(m_blocked_known[word] & bit)) {
+                m_blocked_known[word] |= bit;
+                if (test(id)) {
+                    m_blocked[word] |= bit;
+                }
+            }
+            return (m_blocked[word] & bit) != 0;
+        }
+
+        // Starts the settled-node flags of a bidirectional search (one bit per node, cleared in bulk)
+        void BeginSettledNodes(int32_t node_count) {
+            m_settled.assign((static_cast<size_t>(node_count) + 63) / 64, 0);
+        }
+
+        // Marks a node settled; false if it already was
+        bool Settle(int32_t id) {
+            uint64_t& word = m_settled[static_cast<size_t>(id) >> 6];
+            const uint64_t bit = uint64_t(1) << (id & 63);
+            const bool settled = (word & bit) != 0;
+            word |= bit;
+            return !settled;
+        }
+
+        bool IsSettled(int32_t id) const {
+            return (m_settled[static_cast<size_t>(id) >> 6] >> (id & 63)) & 1;
+        }
+
+        // Nodes waiting to be expanded
+        OpenSet open_set;
+
+        // Obstacles of the current query
+        ObstacleIndex obstacle_index;
+
+        // Storage borrowed by the query overlay (see QueryGraph)
+        std::vector<Point> temp_points;
+        std::vector<std::pair<int32_t, VisibilityEdge>> overlay_edges;
+        std::vector<PointNeighbor> neighbor_scratch;
+
+        // Node IDs of the path found by a contraction hierarchy or hierarchical search
+        std::vector<int32_t> path_nodes;
+
+        // Clusters a hierarchical search walks node by node (1) rather than entrance to entrance (0)
+        std::vector<uint8_t> open_clusters;
+
+        // Nodes of the search tree path of a hierarchical search, before its crossings are expanded
+        std::vector<int32_t> path_hops;
+
+        // Components reached from the start of a query (see ComponentsConnect)
+        ComponentMarks component_marks;
+
+    private:
+        uint32_t m_generation;
+        std::vector<uint32_t> m_stamps;
+        std::vector<float> m_costs;
+        std::vector<int32_t> m_came_from;
+        std::vector<uint64_t> m_blocked_known;
+        std::vector<uint64_t> m_blocked;
+        std::vector<uint64_t> m_settled;
+    };
+
+    // Query-local overlay holding the temporary start/goal points of a single query
+    // Sits on top of an immutable MapData so a query never has to copy the map
+    // Temporary point IDs follow the base IDs: [base.points.size(), base.points.size() + temp_points.size())
+    // The overlay storage is borrowed from a SearchContext, so building it does not allocate once warm
+    struct QueryGraph {
+        const MapData& base;
+        std::vector<Point>& temp_points;                                 // Temporary points (start/goal)
+        std::vector<std::pair<int32_t, VisibilityEdge>>& overlay_edges;  // Edges touching temporary points (from, edge)
+        std::vector<PointNeighbor>& neighbor_scratch;                    // Scratch buffer for point insertion
+
+        QueryGraph(const MapData& map_data, SearchContext& context)
+            : base(map_data)
+            , temp_points(context.temp_points)
+            , overlay_edges(context.overlay_edges)
+            , neighbor_scratch(context.neighbor_scratch) {
+            temp_points.clear();
+            overlay_edges.clear();
+        }
+
+        int32_t BaseCount() const {
+            return static_cast<int32_t>(base.points.size());
+        }
+
+        int32_t PointCount() const {
+            return BaseCount() + static_cast<int32_t>(temp_points.size());
+        }
+
+        bool IsValidId(int32_t id) const {
+            return id >= 0 && id < PointCount();
+        }
+
+        bool IsTemporary(int32_t id) const {
+            return id >= BaseCount();
+        }
+
+        const Point& GetPoint(int32_t id) const {
+            return IsTemporary(id) ? temp_points[id - BaseCount()] : base.points[id];
+        }
+
+        // Adds a temporary point and returns its ID
+        int32_t AddPoint(const Vec2f& pos, int32_t layer) {
+            int32_t new_id = PointCount();
+            temp_points.emplace_back(new_id, pos, layer);
+            return new_id;
+        }
+
+        // Adds a directed edge to the overlay
+        void AddEdge(int32_t from, int32_t to, float distance) {
+            overlay_edges.emplace_back(from, VisibilityEdge(to, distance));
+        }
+
+        // Distance of the longest edge leaving a point (base edges + overlay edges)
+        float MaxEdgeLength(int32_t id) const {
+            float length = IsTemporary(id) ? 0.0f : base.max_edge_lengths[id];
+            for (const auto& extra : overlay_edges) {
+                if (extra.first == id) {
+                    length = std::max(length, extra.second.distance);
+                }
+            }
+            return length;
+        }
+
+        // Calls fn(target_id, distance) for every edge leaving a point (base edges + overlay edges)
+        template <typename Fn>
+        void ForEachEdge(int32_t id, Fn&& fn) const {
+            if (!IsTemporary(id)) {
+                // Contiguous CSR row of the base graph
+                const VisibilityGraph& vis_graph = base.visibility_graph;
+                const uint32_t end = vis_graph.offsets[id + 1];
+                for (uint32_t e = vis_graph.offsets[id]; e < end; ++e) {
+                    fn(vis_graph.targets[e], vis_graph.distances[e]);
+                }
+            }
+
+            // Only a handful of overlay edges exist per query, a linear scan is enough
+            for (const auto& extra : overlay_edges) {
+                if (extra.first == id) {
+                    fn(extra.second.target_id, extra.second.distance);
+                }
+            }
+        }
+    };
+
+    // Outcome of loading a map through the map source
+    enum class MapLoadStatus : int32_t {
+        Loaded = 0,
+        NotFound = 1,   // The source has no data for this map
+        Failed = 2      // The data exists but could not be loaded
+    };
+
+    // Load state of a map, as seen by GetMapLoadState
+    enum class MapLoadState : int32_t {
+        NotLoaded = 0,
+        Loading = 1,    // Queued or in flight
+        Loaded = 2,
+        NotFound = 3,   // The last load found no data for this map
+        Failed = 4      // The last load failed
+    };
+
+    // Fills a map on a cache miss (e.g. from maps.nav / maps.zip), called without any engine lock held
+    using MapSource = std::function<MapLoadStatus(int32_t map_id, MapData& out_map_data)>;
+
+    // Runs a task in the background (e.g. on a thread pool); may run it inline
+    using TaskScheduler = std::function<void(std::function<void()> task)>;
+
+    // Background loading of the maps linked to the active map (travel portals, NPC and enter travel)
+    struct MapWarmingOptions {
+        bool enabled;
+        int32_t max_fan_out;        // Maximum number of linked maps queued when a map becomes active
+        uint64_t byte_budget;       // No warming once the cache holds this much (also capped by the cache budget)
+
+        MapWarmingOptions() : enabled(false), max_fan_out(4), byte_budget(32ull * 1024 * 1024) {}
+    };
+
+    // Per-query part of the A* heuristic, computed once before the search
+    struct HeuristicGoal {
+        Vec2f pos;
+        float teleporter_bound;     // Lower bound of the rest of any path that takes a teleporter (infinity without teleporters)
+        bool use_landmarks;
+        LandmarkTarget landmarks;
+
+        HeuristicGoal() : pos(), teleporter_bound(std::numeric_limits<float>::infinity()), use_landmarks(false) {}
+    };
+
+    // A search that could not run to its end (e.g. a worker of a parallel search failed), as opposed
+    // to one that found no path: FindPathWithObstacles lets it through to the caller
+    struct SearchError : std::runtime_error {
+        explicit SearchError(const std::string& message) : std::runtime_error(message) {}
+    };
+
+    // Direction of the A* search of a query
+    enum class SearchDirection : int32_t {
+        Auto = 0,           // As set by SetBidirectionalSearch
+        Forward = 1,
+        Bidirectional = 2   // Forward and backward frontiers (falls back to Forward on maps with one-way edges)
+    };
+
+    // When queries in Auto direction search from both ends
+    struct BidirectionalSearchOptions {
+        bool enabled;
+        float min_distance;         // Only for a straight-line distance between start and goal of at least this
+        bool parallel;              // Backward frontier on the search scheduler (see SetSearchScheduler)
+
+        BidirectionalSearchOptions() : enabled(false), min_distance(5000.0f), parallel(false) {}
     };
 
     // Main pathfinding class
-    class PathfinderEngine {
+    // All public methods may be called concurrently, except SetMapSource, SetBackgroundScheduler and SetSearchScheduler
+    // which must be called before the engine is shared between threads
+    // Neighbour warming needs the engine to be owned by a shared_ptr (queued loads keep it alive)
+    class PathfinderEngine : public std::enable_shared_from_this<PathfinderEngine> {
     public:
-        PathfinderEngine() = default;
+        PathfinderEngine();
         ~PathfinderEngine() = default;
 
+        // Builds a map from JSON without loading it (spatial indexes built)
+        static bool BuildMapFromJson(int32_t map_id, const std::string& json_data, MapData& out_map_data);
+
+        // Builds a map from the baked binary format without loading it (spatial indexes built)
+        static bool BuildMapFromBinary(int32_t map_id, const uint8_t* data, size_t size, MapData& out_map_data);
+
         // Loads map data from JSON
         bool LoadMapData(int32_t map_id, const std::string& json_data);
 
+        // Loads map data from the baked binary format (see BinaryMapFormat.h)
+        bool LoadMapDataBinary(int32_t map_id, const uint8_t* data, size_t size);
+
+        // Unloads a map (returns false if it was not loaded)
+        bool UnloadMap(int32_t map_id);
+
+        // Returns a loaded map (nullptr if not loaded)
+        // This is the lookup counted as a hit or a miss in the map cache statistics
+        std::shared_ptr<const MapData> GetMapData(int32_t map_id);
+
+        // Cache of the loaded maps (budget, pins, statistics)
+        MapCache& GetMapCache() { return m_map_cache; }
+
+        // Sets where AcquireMap loads missing maps from
+        void SetMapSource(MapSource source);
+
+        // Returns a map, loading it through the map source on a miss
+        // Concurrent calls for the same map share a single load; loads of different maps run in parallel
+        // and never block queries on maps that are already loaded
+        std::shared_ptr<const MapData> AcquireMap(int32_t map_id, MapLoadStatus* out_status = nullptr);
+
+        // Registers a load of a map that is neither loaded nor loading (returns false otherwise)
+        // On true, the caller must call RunLoad(map_id), typically from a background thread;
+        // AcquireMap calls made meanwhile wait for that load instead of starting their own
+        bool BeginLoad(int32_t map_id);
+
+        // Performs a load registered by BeginLoad and wakes the callers waiting on it
+        void RunLoad(int32_t map_id);
+
+        MapLoadState GetMapLoadState(int32_t map_id) const;
+
+        // Blocks until every load registered so far has completed
+        void WaitForLoads();
+
+        // Sets where warming loads are run (warming does nothing without a scheduler)
+        void SetBackgroundScheduler(TaskScheduler scheduler);
+
+        // Sets where the backward frontier of parallel bidirectional searches runs (single thread without one)
+        // Tasks must start soon: a query waits for the ones it cannot take back
+        void SetSearchScheduler(TaskScheduler scheduler);
+
+        // When a map becomes active (AcquireMap on another map than the previous call), the maps it
+        // links to are registered as loads and handed to the background scheduler
+        void SetMapWarming(const MapWarmingOptions& options);
+        MapWarmingOptions GetMapWarming() const;
+
+        // Destination maps of a map's travel portals, NPC and enter travel (unique, in that order)
+        static std::vector<int32_t> GetLinkedMapIds(const MapData& map_data);
+
+        // Builds the contraction hierarchy of maps loaded without one (off by default, see MapData)
+        void SetBuildContractionHierarchies(bool enabled);
+        bool GetBuildContractionHierarchies() const;
+
+        // Builds the cluster level of the maps loaded afterwards, for HierarchicalSearch (off by default)
+        void SetBuildHierarchicalGraphs(bool enabled);
+        bool GetBuildHierarchicalGraphs() const;
+
+        // Also rejects the edges whose segment crosses an obstacle, not only the points inside one (off by default)
+        void SetObstacleEdgeTest(bool enabled);
+        bool GetObstacleEdgeTest() const;
+
+        // Open set layout of the searches: indexed 4-ary heap with decrease-key (default), or binary
+        // heap with duplicate entries, kept as the previous behaviour for benchmarking (see OpenSet)
+        void SetIndexedOpenSet(bool enabled);
+        bool GetIndexedOpenSet() const;
+
+        // Which queries in Auto direction run a bidirectional A* (none by default)
+        void SetBidirectionalSearch(const BidirectionalSearchOptions& options);
+        BidirectionalSearchOptions GetBidirectionalSearch() const;
+
         // Finds a path between two points, avoiding obstacle zones
         // start_layer: the layer of the starting point (-1 = auto-detect)
+        // Without obstacles, maps with a contraction hierarchy are searched through it; other queries
+        // go through the map's cluster level when it has one (HierarchicalSearch), else through A*
+        // in the given direction
+        // Throws SearchError when a parallel bidirectional search fails on the search scheduler
         std::vector<PathPointWithLayer> FindPathWithObstacles(
             int32_t map_id,
             const Vec2f& start,
             int32_t start_layer,
             const Vec2f& goal,
             const std::vector<ObstacleZone>& obstacles,
-            float& out_cost
+            float& out_cost,
+            SearchDirection direction = SearchDirection::Auto
+        );
+
+        // Same, on a map already held by the caller (e.g. from AcquireMap)
+        std::vector<PathPointWithLayer> FindPathWithObstacles(
+            const MapData& map_data,
+            const Vec2f& start,
+            int32_t start_layer,
+            const Vec2f& goal,
+            const std::vector<ObstacleZone>& obstacles,
+            float& out_cost,
+            SearchDirection direction = SearchDirection::Auto
         );
 
+        // Same, writing the path into out_path (cleared first) so that callers can reuse its storage
+        // Returns false when no path was found
+        bool FindPathWithObstacles(
+            const MapData& map_data,
+            const Vec2f& start,
+            int32_t start_layer,
+            const Vec2f& goal,
+            const std::vector<ObstacleZone>& obstacles,
+            std::vector<PathPointWithLayer>& out_path,
+            float& out_cost,
+            SearchDirection direction = SearchDirection::Auto
+        );
+
+        // Checks whether any path joins two points (start_layer as in FindPathWithObstacles)
+        // Only the connected components of the graph are looked at, obstacles are ignored
+        bool IsReachable(const MapData& map_data, const Vec2f& start, int32_t start_layer, const Vec2f& goal);
+
         // Simplifies a path (removes intermediate points that are too close)
         std::vector<PathPointWithLayer> SimplifyPath(
             const std::vector<PathPointWithLayer>& path,
             float min_spacing
         );
 
+        // Same, removing the points from the path itself
+        void SimplifyPathInPlace(std::vector<PathPointWithLayer>& path, float min_spacing);
+
         // Checks if a map is loaded
         bool IsMapLoaded(int32_t map_id) const;
 
@@ -271,21 +1104,92 @@ namespace Pathfinder {
         bool GetMapStatistics(int32_t map_id, MapStatistics& out_stats) const;
 
     private:
-        // A* algorithm
-        std::vector<int32_t> AStar(
-            const MapData& map_data,
+        struct MapLoadResult {
+            std::shared_ptr<const MapData> map;
+            MapLoadStatus status;
+
+            MapLoadResult() : status(MapLoadStatus::NotFound) {}
+        };
+
+        struct PendingLoad {
+            std::promise<MapLoadResult> promise;
+            std::shared_future<MapLoadResult> result;
+            std::atomic<bool> started;      // Set by whoever runs the load (a queued load may be claimed by a query)
+
+            PendingLoad() : started(false) {}
+        };
+
+        // Runs the map source for one map (no lock held)
+        MapLoadResult LoadFromSource(int32_t map_id);
+
+        // Builds what the engine options ask for on a freshly loaded map
+        void PrepareLoadedMap(MapData& map_data) const;
+
+        // Adds a pending load entry (m_load_mutex held)
+        std::shared_ptr<PendingLoad> RegisterLoadUnlocked(int32_t map_id);
+
+        // Runs a pending load unless another thread already started it
+        void RunPendingLoad(int32_t map_id, const std::shared_ptr<PendingLoad>& pending);
+
+        // Queues background loads of the maps linked to a map that just became active
+        void WarmLinkedMaps(const MapData& map_data);
+
+        // A* algorithm with obstacle avoidance (SearchKernel with the filter matching the obstacles)
+        // Nodes inside an obstacle are skipped; with block_crossing_edges, so are edges crossing one
+        // Returns true if the goal was reached; the search tree is left in the context
+        bool AStarWithObstacles(
+            const QueryGraph& graph,
             int32_t start_id,
-            int32_t goal_id
+            int32_t goal_id,
+            const std::vector<ObstacleZone>& obstacles,
+            bool block_crossing_edges,
+            SearchContext& context
         );
 
-        // A* algorithm with obstacle avoidance
-        std::vector<int32_t> AStarWithObstacles(
-            const MapData& map_data,
+        // Bidirectional A* with the same obstacle handling and path costs as AStarWithObstacles, on maps
+        // whose graph is symmetric; the backward frontier runs on scheduler when one is given
+        // Fills context.path_nodes with the nodes of the path, start and goal included
+        bool BidirectionalAStar(
+            const QueryGraph& graph,
             int32_t start_id,
             int32_t goal_id,
-            const std::vector<ObstacleZone>& obstacles
+            const std::vector<ObstacleZone>& obstacles,
+            bool block_crossing_edges,
+            SearchContext& context,
+            SearchContext& backward_context,
+            const TaskScheduler* scheduler
         );
 
+        // Bidirectional search over the map's contraction hierarchy (no obstacles, no heuristic)
+        // Fills context.path_nodes with the nodes of the path, start and goal included
+        bool ContractionHierarchySearch(
+            const QueryGraph& graph,
+            int32_t start_id,
+            int32_t goal_id,
+            SearchContext& context,
+            SearchContext& backward_context
+        );
+
+        // A* over the map's cluster level (HPA*): the clusters holding the start, the goal or an obstacle
+        // are searched node by node, the others are crossed from entrance to entrance, then expanded
+        // back into the nodes stored with each crossing
+        // Same obstacle handling and path costs as AStarWithObstacles
+        // Fills context.path_nodes with the nodes of the path, start and goal included
+        bool HierarchicalSearch(
+            const QueryGraph& graph,
+            int32_t start_id,
+            int32_t goal_id,
+            const std::vector<ObstacleZone>& obstacles,
+            bool block_crossing_edges,
+            SearchContext& context
+        );
+
+        // Returns the search context of the calling thread
+        static SearchContext& GetThreadSearchContext();
+
+        // Second context of the calling thread, for the backward half of bidirectional searches
+        static SearchContext& GetThreadBackwardSearchContext();
+
         // Check if a point is blocked by any obstacle
         bool IsPointBlocked(
             const Vec2f& point,
@@ -305,43 +1209,38 @@ namespace Pathfinder {
             const std::vector<ObstacleZone>& obstacles
         );
 
-        // Calculates the heuristic for A*
-        float Heuristic(
-            const MapData& map_data,
-            const Vec2f& from,
-            const Vec2f& to
-        );
-
-        // Heuristic with teleporters
-        float TeleporterHeuristic(
-            const MapData& map_data,
-            const Vec2f& from,
-            const Vec2f& to
-        );
+        // Prepares the heuristic towards a goal: teleporter bound and landmark bounds of the goal,
+        // the latter from the edges entering it
+        void BeginHeuristic(
+            const QueryGraph& graph,
+            int32_t goal_id,
+            HeuristicGoal& out_goal
+        ) const;
 
         // Reconstructs the path from A* results
         std::vector<PathPointWithLayer> ReconstructPath(
-            const MapData& map_data,
-            const std::vector<int32_t>& came_from,
+            const QueryGraph& graph,
+            const SearchContext& context,
             int32_t start_id,
             int32_t goal_id
         );
 
-        // Reconstructs the path from A* results, including start point
-        std::vector<PathPointWithLayer> ReconstructPathWithStart(
-            const MapData& map_data,
-            const std::vector<int32_t>& came_from,
+        // Reconstructs the path from A* results into out_path, including start point
+        void ReconstructPathWithStart(
+            const QueryGraph& graph,
+            const SearchContext& context,
             int32_t start_id,
-            int32_t goal_id
+            int32_t goal_id,
+            std::vector<PathPointWithLayer>& out_path
         );
 
         // Parses a map's JSON
-        bool ParseMapJson(const std::string& json_data, MapData& out_map_data);
+        static bool ParseMapJson(const std::string& json_data, MapData& out_map_data);
 
         // Creates a temporary point if the position is inside a valid trapezoid
         // Returns the point ID (or -1 if not in a valid trapezoid)
         int32_t CreateTemporaryPoint(
-            MapData& map_data,
+            QueryGraph& graph,
             const Vec2f& pos
         );
 
@@ -349,37 +1248,77 @@ namespace Pathfinder {
         // Uses the layer of the closest existing point
         // Returns the point ID
         int32_t CreateTemporaryPointForced(
-            MapData& map_data,
+            QueryGraph& graph,
             const Vec2f& pos
         );
 
         // Creates a temporary point at the given position with a specific layer
         // Returns the point ID
         int32_t CreateTemporaryPointWithLayer(
-            MapData& map_data,
+            QueryGraph& graph,
             const Vec2f& pos,
             int32_t layer
         );
 
+        // Creates the temporary start and goal points of a query and connects them to the graph
+        // out_goal_used_fallback is set when the goal is off the walkable area
+        // Returns false if either point could not be created
+        bool AttachQueryPoints(
+            QueryGraph& graph,
+            const Vec2f& start,
+            int32_t start_layer,
+            const Vec2f& goal,
+            int32_t& out_start_id,
+            int32_t& out_goal_id,
+            bool& out_goal_used_fallback
+        );
+
+        // Whether a component the start is connected to reaches a component the goal is connected to
+        // (true when the map has no components to tell)
+        static bool ComponentsConnect(
+            const QueryGraph& graph,
+            int32_t start_id,
+            int32_t goal_id,
+            SearchContext& context
+        );
+
         // Inserts a temporary point into the visibility graph by connecting it to nearby points
         // If allow_cross_layer is true, connections can be made across different layers
         void InsertPointIntoVisGraph(
-            MapData& map_data,
+            QueryGraph& graph,
             int32_t point_id,
             int32_t max_connections = 8,
             float max_range = 5000.0f,
             bool allow_cross_layer = false
         );
 
-        // Removes temporary points from the map data (cleanup after pathfinding)
-        void RemoveTemporaryPoints(
-            MapData& map_data,
-            size_t original_point_count,
-            size_t original_visgraph_size
-        );
-
-        // Loaded maps (map_id -> MapData)
-        std::unordered_map<int32_t, MapData> m_loaded_maps;
+        // Loaded maps, parsed and immutable, evicted past the cache budget
+        MapCache m_map_cache;
+
+        MapSource m_map_source;
+
+        // Loads in flight (map_id -> shared result), so a map is only loaded once at a time
+        mutable std::mutex m_load_mutex;
+        std::unordered_map<int32_t, std::shared_ptr<PendingLoad>> m_pending_loads;
+        std::unordered_map<int32_t, MapLoadStatus> m_failed_loads;    // Outcome of the last failed load
+
+        // Neighbour warming
+        TaskScheduler m_background_scheduler;
+        std::atomic<bool> m_warming_enabled;
+        std::atomic<int32_t> m_warming_fan_out;
+        std::atomic<uint64_t> m_warming_byte_budget;
+        std::atomic<int32_t> m_active_map_id;       // Map of the last AcquireMap call
+
+        std::atomic<bool> m_build_contraction_hierarchies;
+        std::atomic<bool> m_build_hierarchical_graphs;
+        std::atomic<bool> m_obstacle_edge_test;
+        std::atomic<bool> m_indexed_open_set;
+
+        // Bidirectional search (see SetBidirectionalSearch)
+        TaskScheduler m_search_scheduler;
+        std::atomic<bool> m_bidirectional_enabled;
+        std::atomic<float> m_bidirectional_min_distance;
+        std::atomic<bool> m_bidirectional_parallel;
     };
 
 } // namespace Pathfinder
@@ -0,0 +1,657 @@
+#pragma once
+
+#include "PathfinderCore.h"
+#include <condition_variable>
+#include <exception>
+
+namespace Pathfinder {
+
+    // A* kernel shared by the searches of the engine, specialized at compile time on three policies:
+    // - edges: which edges leave a node (the graph, or the graph plus cluster crossings);
+    // - filter: which nodes and edges obstacles remove;
+    // - heuristic: which lower bounds apply (teleporters, landmarks).
+    // Every combination compiles into its own loop, without tests for the features it does not use.
+    // A new search mode is a new policy, the loop itself stays shared.
+
+    // ---- Edge policies: ForEachEdge(id, fn) calls fn(target, cost, filtered) for every edge to relax;
+    // edges with filtered = false skip the filter (they are known to be clear)
+
+    // Edges of the query graph
+    struct GraphEdges {
+        const QueryGraph& graph;
+
+        explicit GraphEdges(const QueryGraph& query_graph) : graph(query_graph) {}
+
+        template <typename Fn>
+        void ForEachEdge(int32_t id, Fn&& fn) const {
+            graph.ForEachEdge(id, [&](int32_t target_id, float distance) {
+                fn(target_id, distance, true);
+            });
+        }
+    };
+
+    // Cluster level of a hierarchical search: an entrance of a closed cluster crosses it in one step,
+    // only its edges to other clusters are walked (see HierarchicalGraph)
+    struct ClusterEdges {
+        const QueryGraph& graph;
+        const HierarchicalGraph& clusters;
+        const std::vector<uint8_t>& open_clusters;  // Clusters searched node by node
+
+        ClusterEdges(const QueryGraph& query_graph, const std::vector<uint8_t>& open)
+            : graph(query_graph), clusters(query_graph.base.hierarchical_graph), open_clusters(open) {}
+
+        template <typename Fn>
+        void ForEachEdge(int32_t id, Fn&& fn) const {
+            int32_t closed_cluster = -1;
+            if (!graph.IsTemporary(id)) {
+                const int32_t cluster = clusters.node_clusters[id];
+                const int32_t entrance = clusters.entrance_indices[id];
+                if (!open_clusters[cluster] && entrance >= 0) {
+                    closed_cluster = cluster;
+                    for (uint32_t e = clusters.crossing_offsets[entrance]; e < clusters.crossing_offsets[entrance + 1]; ++e) {
+                        fn(clusters.crossing_targets[e], clusters.crossing_costs[e], false);
+                    }
+                }
+            }
+
+            graph.ForEachEdge(id, [&](int32_t target_id, float distance) {
+                if (closed_cluster >= 0 && !graph.IsTemporary(target_id) &&
+                    clusters.node_clusters[target_id] == closed_cluster) {
+                    return; // Covered by the crossings
+                }
+                fn(target_id, distance, true);
+            });
+        }
+    };
+
+    // ---- Filter policies: SkipNode(id) before a node is expanded, BeginNode(id) once it is,
+    // then Blocks(target, distance) for each of its edges
+
+    // Nothing is blocked
+    struct NoObstacles {
+        bool SkipNode(int32_t) const {
+            return false;
+        }
+
+        void BeginNode(int32_t) {}
+
+        bool Blocks(int32_t, float) const {
+            return false;
+        }
+    };
+
+    // Nodes inside an obstacle are removed, each node is tested at most once per query
+    struct NodeObstacles {
+        const QueryGraph& graph;
+        const std::vector<ObstacleZone>& obstacles;
+        SearchContext& context;
+
+        NodeObstacles(const QueryGraph& query_graph, const std::vector<ObstacleZone>& query_obstacles, SearchContext& search_context)
+            : graph(query_graph), obstacles(query_obstacles), context(search_context) {
+            context.obstacle_index.Build(obstacles);
+            context.BeginBlockedNodes(graph.PointCount());
+        }
+
+        bool SkipNode(int32_t id) {
+            return context.IsBlocked(id, [&](int32_t node_id) {
+                return context.obstacle_index.Contains(obstacles, graph.GetPoint(node_id).pos);
+            });
+        }
+
+        void BeginNode(int32_t) {}
+
+        bool Blocks(int32_t target_id, float) {
+            return SkipNode(target_id);
+        }
+    };
+
+    // Nodes inside an obstacle and walked edges crossing one are removed (teleporter hops are cheaper
+    // than their length and are not walked)
+    struct EdgeObstacles : NodeObstacles {
+        Vec2f from_pos;
+
+        EdgeObstacles(const QueryGraph& query_graph, const std::vector<ObstacleZone>& query_obstacles, SearchContext& search_context)
+            : NodeObstacles(query_graph, query_obstacles, search_context), from_pos() {}
+
+        // Walked edges are as long as their distance: only the obstacles the longest edge of the node
+        // can reach (kept per point at load) are tested against its edges
+        void BeginNode(int32_t id) {
+            from_pos = graph.GetPoint(id).pos;
+            context.obstacle_index.SelectNear(obstacles, from_pos, graph.MaxEdgeLength(id));
+        }
+
+        bool Blocks(int32_t target_id, float distance) {
+            if (SkipNode(target_id)) {
+                return true;
+            }
+            if (!context.obstacle_index.HasNear()) {
+                return false;
+            }
+            const Vec2f& target_pos = graph.GetPoint(target_id).pos;
+            return distance * distance * 4.0f >= from_pos.SquaredDistance(target_pos) &&
+                   context.obstacle_index.IntersectsSegment(from_pos, target_pos);
+        }
+    };
+
+    // ---- Heuristic policy: the straight-line distance, lowered by the teleporter bound when the map
+    // has teleporters, raised to the landmark bound when the map has landmarks (never for temporary points)
+    template <bool kTeleporters, bool kLandmarks>
+    struct GoalHeuristic {
+        const QueryGraph& graph;
+        const HeuristicGoal& goal;
+
+        GoalHeuristic(const QueryGraph& query_graph, const HeuristicGoal& heuristic_goal)
+            : graph(query_graph), goal(heuristic_goal) {}
+
+        float operator()(int32_t id) const {
+            const MapData& map_data = graph.base;
+            const Vec2f& pos = graph.GetPoint(id).pos;
+            const bool temporary = graph.IsTemporary(id);
+
+            float estimate = pos.Distance(goal.pos);
+            if (kTeleporters) {
+                // Walk to the nearest entry (table lookup), then the bound of the rest of the path
+                const float entry_distance = temporary ? map_data.TeleporterEntryDistance(pos)
+                                                       : map_data.teleporter_entry_distances[id];
+                estimate = std::min(estimate, entry_distance + goal.teleporter_bound);
+            }
+            if (kLandmarks && !temporary) {
+                estimate = std::max(estimate, map_data.landmarks.LowerBound(id, goal.landmarks));
+            }
+            return estimate;
+        }
+    };
+
+    // A* from start_id until goal_id is popped; the search tree is left in the context
+    template <typename Edges, typename Filter, typename Heuristic>
+    bool SearchKernel(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        const Edges& edges,
+        Filter& filter,
+        const Heuristic& heuristic,
+        SearchContext& context
+    ) {
+        OpenSet& open_set = context.open_set;
+        context.Begin(graph.PointCount());
+        context.Update(start_id, 0.0f, start_id);
+        open_set.Push(0.0f, start_id);
+
+        int32_t current_id = -1;
+        while (!open_set.Empty()) {
+            current_id = open_set.Pop().second;
+            if (current_id == goal_id) {
+                break; // Path found
+            }
+
+            if (filter.SkipNode(current_id)) {
+                continue;
+            }
+            filter.BeginNode(current_id);
+
+            const float current_cost = context.Cost(current_id);
+            edges.ForEachEdge(current_id, [&](int32_t neighbor_id, float cost, bool filtered) {
+                if (filtered && filter.Blocks(neighbor_id, cost)) {
+                    return;
+                }
+
+                const float new_cost = current_cost + cost;
+                if (new_cost < context.Cost(neighbor_id)) {
+                    context.Update(neighbor_id, new_cost, current_id);
+
+                    // Infinity: the goal cannot be reached from there
+                    const float priority = new_cost + heuristic(neighbor_id);
+                    if (priority < std::numeric_limits<float>::infinity()) {
+                        open_set.Push(priority, neighbor_id);
+                    }
+                }
+            });
+        }
+
+        return current_id == goal_id;
+    }
+
+    // Runs the kernel with the heuristic policy matching the map (goal prepared by BeginHeuristic)
+    template <typename Edges, typename Filter>
+    bool SearchKernelWithGoal(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        const Edges& edges,
+        Filter& filter,
+        const HeuristicGoal& goal,
+        SearchContext& context
+    ) {
+        const bool teleporters = !graph.base.teleporter_entry_distances.empty();
+        if (teleporters && goal.use_landmarks) {
+            return SearchKernel(graph, start_id, goal_id, edges, filter, GoalHeuristic<true, true>(graph, goal), context);
+        }
+        if (teleporters) {
+            return SearchKernel(graph, start_id, goal_id, edges, filter, GoalHeuristic<true, false>(graph, goal), context);
+        }
+        if (goal.use_landmarks) {
+            return SearchKernel(graph, start_id, goal_id, edges, filter, GoalHeuristic<false, true>(graph, goal), context);
+        }
+        return SearchKernel(graph, start_id, goal_id, edges, filter, GoalHeuristic<false, false>(graph, goal), context);
+    }
+
+    // Runs the kernel with the filter policy matching the obstacles of the query
+    template <typename Edges>
+    bool SearchKernelWithObstacles(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        const Edges& edges,
+        const std::vector<ObstacleZone>& obstacles,
+        bool block_crossing_edges,
+        const HeuristicGoal& goal,
+        SearchContext& context
+    ) {
+        if (obstacles.empty()) {
+            NoObstacles filter;
+            return SearchKernelWithGoal(graph, start_id, goal_id, edges, filter, goal, context);
+        }
+        if (!block_crossing_edges) {
+            NodeObstacles filter(graph, obstacles, context);
+            return SearchKernelWithGoal(graph, start_id, goal_id, edges, filter, goal, context);
+        }
+        EdgeObstacles filter(graph, obstacles, context);
+        return SearchKernelWithGoal(graph, start_id, goal_id, edges, filter, goal, context);
+    }
+
+    // Nodes each frontier of a parallel bidirectional search expands between two synchronizations
+    constexpr int32_t kBidirectionalRoundSize = 256;
+
+    // ---- Bidirectional A* (NBA*): a forward frontier from the start and a backward one from the goal,
+    // on a symmetric graph (MapData::symmetric_graph) so that both walk the same edges and the heuristic
+    // towards the start bounds the distance from it. best is the cheapest path through a node reached
+    // by both. A node is settled the first time it is taken and expanded only if paths through it can
+    // still beat best: its priority must be below best, and so must its cost plus the smallest priority
+    // of the other frontier minus its heuristic towards the other end (the heuristics are consistent,
+    // so that sum bounds any path going on through the other frontier). The search ends once a frontier
+    // is empty or its smallest priority reaches best
+
+    // One frontier of a bidirectional search
+    template <typename Filter, typename Heuristic>
+    class SearchFrontier {
+    public:
+        SearchFrontier(const QueryGraph& graph, Filter& filter, const Heuristic& heuristic, SearchContext& context)
+            : m_graph(graph), m_edges(graph), m_filter(filter), m_heuristic(heuristic), m_context(context) {}
+
+        void Start(int32_t root_id) {
+            m_context.Begin(m_graph.PointCount());
+            m_context.BeginSettledNodes(m_graph.PointCount());
+            m_context.Update(root_id, 0.0f, root_id);
+            m_context.open_set.Push(m_heuristic(root_id), root_id);
+        }
+
+        const SearchContext& Context() const {
+            return m_context;
+        }
+
+        // Heuristic towards the root of the other frontier
+        const Heuristic& HeuristicPolicy() const {
+            return m_heuristic;
+        }
+
+        bool Done(float best_cost) const {
+            return m_context.open_set.Empty() || m_context.open_set.MinPriority() >= best_cost;
+        }
+
+        size_t OpenCount() const {
+            return m_context.open_set.Size();
+        }
+
+        // Smallest priority of the open nodes (infinity once there are none)
+        float MinPriority() const {
+            return m_context.open_set.Empty() ? std::numeric_limits<float>::infinity() : m_context.open_set.MinPriority();
+        }
+
+        // Takes the best open node and expands it unless it is settled already or pruned (see above);
+        // edges to nodes for which skip(id) holds are left out, on_reached(id, cost) is called for
+        // every node whose cost improves
+        template <typename Skip, typename Fn>
+        void ExpandNext(float best_cost, float other_min_priority, const Heuristic& other_heuristic, Skip&& skip, Fn&& on_reached) {
+            const OpenSet::Entry current = m_context.open_set.Pop();
+            const int32_t current_id = current.second;
+            if (!m_context.Settle(current_id) || m_filter.SkipNode(current_id)) {
+                return;
+            }
+
+            // The first entry of a node carries its final cost, so its priority is cost + heuristic
+            const float current_cost = m_context.Cost(current_id);
+            if (current.first >= best_cost ||
+                current_cost + other_min_priority - other_heuristic(current_id) >= best_cost) {
+                return;
+            }
+            m_filter.BeginNode(current_id);
+
+            m_edges.ForEachEdge(current_id, [&](int32_t neighbor_id, float cost, bool filtered) {
+                if (m_context.IsSettled(neighbor_id) || skip(neighbor_id)) {
+                    return;
+                }
+                if (filtered && m_filter.Blocks(neighbor_id, cost)) {
+                    return;
+                }
+
+                const float new_cost = current_cost + cost;
+                if (new_cost < m_context.Cost(neighbor_id)) {
+                    m_context.Update(neighbor_id, new_cost, current_id);
+                    on_reached(neighbor_id, new_cost);
+
+                    const float priority = new_cost + m_heuristic(neighbor_id);
+                    if (priority < std::numeric_limits<float>::infinity()) {
+                        m_context.open_set.Push(priority, neighbor_id);
+                    }
+                }
+            });
+        }
+
+    private:
+        const QueryGraph& m_graph;
+        const GraphEdges m_edges;
+        Filter& m_filter;
+        const Heuristic& m_heuristic;
+        SearchContext& m_context;
+    };
+
+    // Joins the two search trees at meeting_id into out_nodes (start to goal)
+    inline bool JoinFrontiers(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        int32_t meeting_id,
+        const SearchContext& forward_context,
+        const SearchContext& backward_context,
+        std::vector<int32_t>& out_nodes
+    ) {
+        out_nodes.clear();
+        for (int32_t id = meeting_id; ; id = forward_context.CameFrom(id)) {
+            out_nodes.push_back(id);
+            if (id == start_id || static_cast<int32_t>(out_nodes.size()) > graph.PointCount()) {
+                break;
+            }
+        }
+        if (out_nodes.back() != start_id) {
+            return false;
+        }
+        std::reverse(out_nodes.begin(), out_nodes.end());
+
+        for (int32_t id = meeting_id; id != goal_id; ) {
+            id = backward_context.CameFrom(id);
+            if (id < 0 || static_cast<int32_t>(out_nodes.size()) > graph.PointCount()) {
+                return false;
+            }
+            out_nodes.push_back(id);
+        }
+        return true;
+    }
+
+    // Bidirectional A*, one frontier at a time (the one with fewer open nodes); a node settled by
+    // either frontier is never entered by the other
+    // Fills forward_context.path_nodes with the nodes of the path, start and goal included
+    template <typename Filter, typename Heuristic>
+    bool BidirectionalKernel(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        SearchFrontier<Filter, Heuristic>& forward,
+        SearchFrontier<Filter, Heuristic>& backward,
+        SearchContext& forward_context
+    ) {
+        forward.Start(start_id);
+        backward.Start(goal_id);
+
+        float best_cost = std::numeric_limits<float>::infinity();
+        int32_t meeting_id = -1;
+        while (!forward.Done(best_cost) && !backward.Done(best_cost)) {
+            const bool expand_forward = forward.OpenCount() <= backward.OpenCount();
+            SearchFrontier<Filter, Heuristic>& own = expand_forward ? forward : backward;
+            const SearchFrontier<Filter, Heuristic>& other = expand_forward ? backward : forward;
+            const SearchContext& other_context = other.Context();
+            own.ExpandNext(best_cost, other.MinPriority(), other.HeuristicPolicy(),
+                [&](int32_t id) {
+                    return other_context.IsSettled(id);
+                },
+                [&](int32_t id, float cost) {
+                    const float path_cost = cost + other_context.Cost(id);
+                    if (path_cost < best_cost) {
+                        best_cost = path_cost;
+                        meeting_id = id;
+                    }
+                });
+        }
+
+        return meeting_id >= 0 &&
+               JoinFrontiers(graph, start_id, goal_id, meeting_id, forward.Context(), backward.Context(),
+                             forward_context.path_nodes);
+    }
+
+    // Bidirectional A* with the backward frontier on another thread. The frontiers expand in rounds of
+    // round_size nodes without looking at each other: each one prunes with best and the other's smallest
+    // priority as of the start of the round (both only ever tighten, so older values prune less but
+    // never wrongly), and only avoids the nodes it settled itself. Between rounds the nodes each one
+    // reached are matched against the other's costs, then the end of the search is checked. A round the
+    // scheduler has not started by the time the forward one is done is run by the calling thread, so a
+    // busy pool only costs the parallelism, never progress
+    // Throws SearchError if the backward expansions fail on the scheduler's thread; the frame is only
+    // left once no task can touch it anymore
+    template <typename Filter, typename Heuristic>
+    bool ParallelBidirectionalKernel(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        SearchFrontier<Filter, Heuristic>& forward,
+        SearchFrontier<Filter, Heuristic>& backward,
+        SearchContext& forward_context,
+        const TaskScheduler& scheduler,
+        int32_t round_size
+    ) {
+        // Expansions of one frontier during a round
+        struct Batch {
+            SearchFrontier<Filter, Heuristic>* frontier;
+            const Heuristic* other_heuristic;
+            float best_cost;
+            float other_min_priority;
+            int32_t round_size;
+            std::vector<int32_t> reached;
+
+            void Run() {
+                reached.clear();
+                for (int32_t i = 0; i < round_size && frontier->OpenCount() > 0; ++i) {
+                    frontier->ExpandNext(best_cost, other_min_priority, *other_heuristic,
+                        [](int32_t) {
+                            return false;
+                        },
+                        [&](int32_t id, float) {
+                            reached.push_back(id);
+                        });
+                }
+            }
+        };
+
+        // One per query, shared with its tasks. A task the calling thread took a round back from may
+        // only start after the query ended: the object counts its references (the query's and one per
+        // task) and the last one deletes it. Rounds are numbered from 1; the caller and the task of a
+        // round race to claim its number, the winner runs the backward expansions
+        struct Round {
+            std::atomic<int32_t> references;
+            std::atomic<uint32_t> claimed;      // Last round claimed
+            std::mutex mutex;
+            std::condition_variable done_signal;
+            uint32_t done;                      // Last round run by a task
+            std::exception_ptr failure;         // Of that round
+            Batch* work;                        // Only used by the task that claimed the current round
+
+            explicit Round(Batch* backward_work) : references(1), claimed(0), done(0), work(backward_work) {}
+
+            bool Claim(uint32_t number) {
+                uint32_t expected = number - 1;
+                return claimed.compare_exchange_strong(expected, number);
+            }
+
+            void Release() {
+                if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    delete this;
+                }
+            }
+
+            // Runs the backward expansions of a round unless the caller claimed it first
+            void RunTask(uint32_t number) {
+                if (Claim(number)) {
+                    std::exception_ptr task_failure;
+                    try {
+                        work->Run();
+                    }
+                    catch (...) {
+                        task_failure = std::current_exception();
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        failure = task_failure;
+                        done = number;
+                    }
+                    done_signal.notify_one();
+                }
+                Release();
+            }
+
+            void WaitDone(uint32_t number) {
+                std::unique_lock<std::mutex> lock(mutex);
+                done_signal.wait(lock, [&] { return done == number; });
+            }
+        };
+
+        // Releases the query's reference however the frame is left
+        struct RoundOwner {
+            Round* round;
+
+            ~RoundOwner() {
+                round->Release();
+            }
+        };
+
+        forward.Start(start_id);
+        backward.Start(goal_id);
+
+        Batch forward_batch = { &forward, &backward.HeuristicPolicy(), 0.0f, 0.0f, round_size, {} };
+        Batch backward_batch = { &backward, &forward.HeuristicPolicy(), 0.0f, 0.0f, round_size, {} };
+        const RoundOwner owner = { new Round(&backward_batch) };
+        Round* round = owner.round;
+        uint32_t number = 0;
+
+        float best_cost = std::numeric_limits<float>::infinity();
+        int32_t meeting_id = -1;
+        while (!forward.Done(best_cost) && !backward.Done(best_cost)) {
+            forward_batch.best_cost = backward_batch.best_cost = best_cost;
+            forward_batch.other_min_priority = backward.MinPriority();
+            backward_batch.other_min_priority = forward.MinPriority();
+
+            // The task holds a pointer and a number only, small enough for the function's inline storage
+            ++number;
+            round->references.fetch_add(1, std::memory_order_relaxed);
+            try {
+                scheduler([round, number]() {
+                    round->RunTask(number);
+                });
+            }
+            catch (...) {
+                round->Release(); // Not queued
+                throw;
+            }
+
+            // The backward frontier is the task's until the round is claimed back or done
+            std::exception_ptr forward_failure;
+            try {
+                forward_batch.Run();
+            }
+            catch (...) {
+                forward_failure = std::current_exception();
+            }
+            if (round->Claim(number)) {
+                if (forward_failure) {
+                    std::rethrow_exception(forward_failure);
+                }
+                backward_batch.Run();
+            }
+            else {
+                round->WaitDone(number);
+                if (forward_failure) {
+                    std::rethrow_exception(forward_failure);
+                }
+                if (round->failure) {
+                    try {
+                        std::rethrow_exception(round->failure);
+                    }
+                    catch (const std::exception& e) {
+                        throw SearchError(std::string("Backward search failed: ") + e.what());
+                    }
+                    catch (...) {
+                        throw SearchError("Backward search failed");
+                    }
+                }
+            }
+
+            const SearchContext& forward_costs = forward.Context();
+            const SearchContext& backward_costs = backward.Context();
+            for (const Batch* batch : { &forward_batch, &backward_batch }) {
+                for (int32_t id : batch->reached) {
+                    const float path_cost = forward_costs.Cost(id) + backward_costs.Cost(id);
+                    if (path_cost < best_cost) {
+                        best_cost = path_cost;
+                        meeting_id = id;
+                    }
+                }
+            }
+        }
+
+        return meeting_id >= 0 &&
+               JoinFrontiers(graph, start_id, goal_id, meeting_id, forward.Context(), backward.Context(),
+                             forward_context.path_nodes);
+    }
+
+    // Runs a bidirectional kernel with the heuristic policy matching the map (goals prepared by
+    // BeginHeuristic, towards the goal and towards the start); scheduler is null for a single thread
+    template <typename Filter>
+    bool BidirectionalKernelWithGoal(
+        const QueryGraph& graph,
+        int32_t start_id,
+        int32_t goal_id,
+        Filter& forward_filter,
+        Filter& backward_filter,
+        const HeuristicGoal& forward_goal,
+        const HeuristicGoal& backward_goal,
+        SearchContext& forward_context,
+        SearchContext& backward_context,
+        const TaskScheduler* scheduler
+    ) {
+        auto run = [&](auto heuristic_tag) {
+            using Heuristic = decltype(heuristic_tag);
+            const Heuristic forward_heuristic(graph, forward_goal);
+            const Heuristic backward_heuristic(graph, backward_goal);
+            SearchFrontier<Filter, Heuristic> forward(graph, forward_filter, forward_heuristic, forward_context);
+            SearchFrontier<Filter, Heuristic> backward(graph, backward_filter, backward_heuristic, backward_context);
+            if (scheduler) {
+                return ParallelBidirectionalKernel(graph, start_id, goal_id, forward, backward, forward_context,
+                                                   *scheduler, kBidirectionalRoundSize);
+            }
+            return BidirectionalKernel(graph, start_id, goal_id, forward, backward, forward_context);
+        };
+
+        // Landmarks apply to both goals or to none (same map, base and temporary points alike)
+        const bool teleporters = !graph.base.teleporter_entry_distances.empty();
+        const bool landmarks = forward_goal.use_landmarks && backward_goal.use_landmarks;
+        if (teleporters && landmarks) {
+            return run(GoalHeuristic<true, true>(graph, forward_goal));
+        }
+        if (teleporters) {
+            return run(GoalHeuristic<true, false>(graph, forward_goal));
+        }
+        if (landmarks) {
+            return run(GoalHeuristic<false, true>(graph, forward_goal));
+        }
+        return run(GoalHeuristic<false, false>(graph, forward_goal));
+    }
+
+} // namespace Pathfinder
@@ -0,0 +1,183 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace Pathfinder {
+
+    ThreadPool::ThreadPool(size_t worker_count)
+        : m_queued(0)
+        , m_next_queue(0)
+        , m_stop(false) {
+        for (size_t i = 0; i <= worker_count; ++i) {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        m_threads.reserve(worker_count);
+        for (size_t i = 0; i < worker_count; ++i) {
+            m_threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& fn, size_t min_chunk) {
+        if (count == 0) {
+            return;
+        }
+
+        const size_t thread_count = m_threads.size() + 1;
+        const size_t chunk = std::max<size_t>(std::max<size_t>(min_chunk, 1), count / (thread_count * 4));
+        const size_t chunk_count = (count + chunk - 1) / chunk;
+
+        if (chunk_count == 1 || m_threads.empty()) {
+            for (size_t i = 0; i < count; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        // The last decrement happens under done_mutex, and the caller takes done_mutex before
+        // returning, so no task can touch these locals once ParallelFor has returned
+        std::atomic<size_t> remaining(chunk_count);
+        std::mutex done_mutex;
+        std::condition_variable done;
+
+        // Counted before being queued, so the count never goes below the number of queued tasks
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+            m_queued.fetch_add(chunk_count, std::memory_order_release);
+        }
+
+        // Chunks are dealt round-robin, stealing evens out whatever the split got wrong
+        for (size_t c = 0; c < chunk_count; ++c) {
+            const size_t begin = c * chunk;
+            const size_t end = std::min(count, begin + chunk);
+
+            WorkerQueue& queue = *m_queues[c % m_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back([&fn, &remaining, &done_mutex, &done, begin, end]() {
+                for (size_t i = begin; i < end; ++i) {
+                    fn(i);
+                }
+
+                std::lock_guard<std::mutex> done_lock(done_mutex);
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    done.notify_all();
+                }
+            });
+        }
+
+        m_wake.notify_all();
+
+        // Help until every chunk of this batch has run (possibly on other threads)
+        const size_t caller_queue = m_queues.size() - 1;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!RunPendingTask(caller_queue, false)) {
+                std::unique_lock<std::mutex> lock(done_mutex);
+                done.wait(lock, [&remaining]() { return remaining.load(std::memory_order_acquire) == 0; });
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(done_mutex);
+    }
+
+    void ThreadPool::Submit(std::function<void()> task) {
+        if (m_threads.empty()) {
+            task();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+            m_queued.fetch_add(1, std::memory_order_release);
+        }
+
+        WorkerQueue& queue = *m_queues[m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_threads.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+    }
+
+    void ThreadPool::SubmitLowPriority(std::function<void()> task) {
+        if (m_threads.empty()) {
+            task();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+            m_queued.fetch_add(1, std::memory_order_release);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_low_priority.mutex);
+            m_low_priority.tasks.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+    }
+
+    bool ThreadPool::RunPendingTask(size_t queue_index, bool allow_low_priority) {
+        std::function<void()> task;
+
+        for (size_t attempt = 0; attempt < m_queues.size() && !task; ++attempt) {
+            WorkerQueue& queue = *m_queues[(queue_index + attempt) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+
+            // Own work from the front, stolen work from the back
+            if (attempt == 0) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            else {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+        }
+
+        // Low priority work only once every regular queue is empty (in submission order)
+        if (!task && allow_low_priority) {
+            std::lock_guard<std::mutex> lock(m_low_priority.mutex);
+            if (!m_low_priority.tasks.empty()) {
+                task = std::move(m_low_priority.tasks.front());
+                m_low_priority.tasks.pop_front();
+            }
+        }
+
+        if (!task) {
+            return false;
+        }
+
+        m_queued.fetch_sub(1, std::memory_order_acq_rel);
+        task();
+        return true;
+    }
+
+    void ThreadPool::WorkerLoop(size_t queue_index) {
+        for (;;) {
+            if (RunPendingTask(queue_index, true)) {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_wake_mutex);
+            m_wake.wait(lock, [this]() { return m_stop || m_queued.load(std::memory_order_acquire) > 0; });
+            if (m_stop) {
+                return;
+            }
+        }
+    }
+
+} // namespace Pathfinder
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Pathfinder {
+
+    /**
+     * @brief Work-stealing thread pool
+     *
+     * Each worker owns a task deque: it pops from the front of its own deque and, when
+     * empty, steals from the back of the others. The thread calling ParallelFor takes part
+     * in the work until its batch is done, so a ParallelFor issued from a task cannot deadlock.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * @param worker_count Number of worker threads (0 = the calling thread does all the work)
+         */
+        explicit ThreadPool(size_t worker_count);
+        ~ThreadPool();
+
+        size_t WorkerCount() const { return m_threads.size(); }
+
+        /**
+         * @brief Calls fn(i) for every i in [0, count) and returns once all calls are done
+         *
+         * The range is split into chunks of at least min_chunk indices, a few per thread so
+         * that uneven work gets balanced by stealing. fn must not throw.
+         */
+        void ParallelFor(size_t count, const std::function<void(size_t)>& fn, size_t min_chunk = 1);
+
+        /**
+         * @brief Queues a task and returns immediately (the task runs inline if the pool has no worker)
+         */
+        void Submit(std::function<void()> task);
+
+        /**
+         * @brief Queues a task that only runs when no regular task is waiting (runs inline if the pool has no worker)
+         */
+        void SubmitLowPriority(std::function<void()> task);
+
+        // Disallow copying
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        // Runs one queued task, own queue first then stealing (returns false if none was found)
+        // Low priority tasks are left to the workers, so ParallelFor callers never get held up by one
+        bool RunPendingTask(size_t queue_index, bool allow_low_priority);
+
+        void WorkerLoop(size_t queue_index);
+
+        // One queue per worker, plus one for the threads calling ParallelFor
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        WorkerQueue m_low_priority;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_wake_mutex;
+        std::condition_variable m_wake;
+        std::atomic<size_t> m_queued;
+        std::atomic<size_t> m_next_queue;
+        bool m_stop;
+    };
+
+} // namespace Pathfinder
@@ -0,0 +1,243 @@
+#include "WorldGraph.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace Pathfinder {
+
+    namespace {
+
+        // Walking distance between two positions of a map (infinity if there is no path)
+        float WalkCost(PathfinderEngine& engine, const MapData& map_data, const Vec2f& from, const Vec2f& to) {
+            static const std::vector<ObstacleZone> no_obstacles;
+            float cost = 0.0f;
+            if (engine.FindPathWithObstacles(map_data, from, -1, to, no_obstacles, cost).empty()) {
+                return std::numeric_limits<float>::infinity();
+            }
+            return cost;
+        }
+
+        // Walks from or to a few positions, each distinct position searched once
+        // (the connections of a portal share its position, the transitions of a map often share an arrival)
+        class WalkCache {
+        public:
+            WalkCache(PathfinderEngine& engine, const MapData& map_data) : m_engine(engine), m_map_data(map_data) {}
+
+            float Get(const Vec2f& from, const Vec2f& to) {
+                for (const auto& walk : m_walks) {
+                    if (walk.from.x == from.x && walk.from.y == from.y && walk.to.x == to.x && walk.to.y == to.y) {
+                        return walk.cost;
+                    }
+                }
+                const float cost = WalkCost(m_engine, m_map_data, from, to);
+                m_walks.push_back({ from, to, cost });
+                return cost;
+            }
+
+        private:
+            struct Walk {
+                Vec2f from;
+                Vec2f to;
+                float cost;
+            };
+
+            PathfinderEngine& m_engine;
+            const MapData& m_map_data;
+            std::vector<Walk> m_walks;
+        };
+    }
+
+    void WorldGraph::AddMap(const MapData& map_data) {
+        if (map_indices.count(map_data.map_id) > 0) {
+            return;
+        }
+
+        map_indices[map_data.map_id] = MapCount();
+        map_ids.push_back(map_data.map_id);
+        travel_costs.push_back(map_data.travel_costs);
+        for (const auto& transition : map_data.GetTransitions()) {
+            transitions.push_back(transition);
+        }
+        transition_offsets.push_back(static_cast<uint32_t>(transitions.size()));
+    }
+
+    void WorldGraph::Link() {
+        dest_maps.assign(transitions.size(), -1);
+        arrival_rows.assign(transitions.size(), -1);
+        for (size_t t = 0; t < transitions.size(); ++t) {
+            const int32_t dest = MapIndex(transitions[t].dest_map_id);
+            if (dest >= 0) {
+                dest_maps[t] = dest;
+                arrival_rows[t] = travel_costs[dest].FindArrival(transitions[t].dest_pos);
+            }
+        }
+    }
+
+    float WorldGraph::FindTransitions(const std::vector<std::pair<int32_t, float>>& start_costs,
+                                      const std::vector<std::pair<int32_t, float>>& goal_costs,
+                                      std::vector<int32_t>& out_transitions) const {
+        out_transitions.clear();
+        const float infinity = std::numeric_limits<float>::infinity();
+        std::vector<float> costs(transitions.size(), infinity);
+        std::vector<float> remaining(transitions.size(), infinity);
+        std::vector<int32_t> came_from(transitions.size(), -1);
+
+        using QueueEntry = std::pair<float, int32_t>;
+        const std::greater<QueueEntry> queue_order;
+        std::vector<QueueEntry> queue;
+        for (const auto& start : start_costs) {
+            if (start.second < costs[start.first]) {
+                costs[start.first] = start.second;
+                queue.emplace_back(start.second, start.first);
+            }
+        }
+        std::make_heap(queue.begin(), queue.end(), queue_order);
+        for (const auto& goal : goal_costs) {
+            remaining[goal.first] = std::min(remaining[goal.first], goal.second);
+        }
+
+        // The best route so far ends with last; nothing popped at its cost or more can improve it
+        float best = infinity;
+        int32_t last = -1;
+        while (!queue.empty() && queue.front().first < best) {
+            std::pop_heap(queue.begin(), queue.end(), queue_order);
+            const QueueEntry current = queue.back();
+            queue.pop_back();
+            if (current.first > costs[current.second]) {
+                continue; // Stale entry
+            }
+
+            if (current.first + remaining[current.second] < best) {
+                best = current.first + remaining[current.second];
+                last = current.second;
+            }
+
+            // Walk from the arrival of the transition to every transition of its destination
+            const int32_t dest = dest_maps[current.second];
+            const int32_t row = arrival_rows[current.second];
+            if (dest < 0 || row < 0) {
+                continue;
+            }
+
+            const uint32_t first = transition_offsets[dest];
+            const uint32_t count = transition_offsets[dest + 1] - first;
+            const float* walks = travel_costs[dest].costs.data() + static_cast<size_t>(row) * count;
+            for (uint32_t column = 0; column < count; ++column) {
+                const float cost = current.first + walks[column];
+                if (cost < costs[first + column]) {
+                    costs[first + column] = cost;
+                    came_from[first + column] = current.second;
+                    queue.emplace_back(cost, static_cast<int32_t>(first + column));
+                    std::push_heap(queue.begin(), queue.end(), queue_order);
+                }
+            }
+        }
+
+        for (int32_t t = last; t >= 0; t = came_from[t]) {
+            out_transitions.push_back(t);
+        }
+        std::reverse(out_transitions.begin(), out_transitions.end());
+        return best;
+    }
+
+    void BuildTravelCosts(PathfinderEngine& engine, MapData& map_data, const std::vector<Vec2f>& arrivals) {
+        const std::vector<MapTransition> transitions = map_data.GetTransitions();
+        TravelCostTable table;
+        table.arrivals = arrivals;
+        table.costs.reserve(arrivals.size() * transitions.size());
+
+        WalkCache walks(engine, map_data);
+        for (const auto& arrival : arrivals) {
+            for (const auto& transition : transitions) {
+                table.costs.push_back(walks.Get(arrival, transition.position));
+            }
+        }
+        map_data.travel_costs = std::move(table);
+    }
+
+    bool FindWorldRoute(PathfinderEngine& engine, const WorldGraph& world,
+                        const MapData& start_map, const Vec2f& start, const MapData& goal_map, const Vec2f& goal,
+                        std::vector<WorldRouteLeg>& out_legs, float& out_cost) {
+        out_legs.clear();
+        out_cost = std::numeric_limits<float>::infinity();
+
+        WalkCache start_walks(engine, start_map);
+        WalkCache goal_walks(engine, goal_map);
+
+        // Staying on the map
+        if (start_map.map_id == goal_map.map_id) {
+            out_cost = start_walks.Get(start, goal);
+        }
+
+        // Walks from the start to the transitions of its map, and from every arrival on the goal map to the goal
+        std::vector<std::pair<int32_t, float>> start_costs;
+        const int32_t start_index = world.MapIndex(start_map.map_id);
+        if (start_index >= 0) {
+            for (uint32_t t = world.transition_offsets[start_index]; t < world.transition_offsets[start_index + 1]; ++t) {
+                const float cost = start_walks.Get(start, world.transitions[t].position);
+                if (cost < std::numeric_limits<float>::infinity()) {
+                    start_costs.emplace_back(static_cast<int32_t>(t), cost);
+                }
+            }
+        }
+
+        std::vector<std::pair<int32_t, float>> goal_costs;
+        for (size_t t = 0; t < world.transitions.size(); ++t) {
+            if (world.transitions[t].dest_map_id == goal_map.map_id) {
+                const float cost = goal_walks.Get(world.transitions[t].dest_pos, goal);
+                if (cost < std::numeric_limits<float>::infinity()) {
+                    goal_costs.emplace_back(static_cast<int32_t>(t), cost);
+                }
+            }
+        }
+
+        std::vector<int32_t> chain;
+        const float chain_cost = world.FindTransitions(start_costs, goal_costs, chain);
+        if (chain.empty() || chain_cost >= out_cost) {
+            if (out_cost == std::numeric_limits<float>::infinity()) {
+                return false;
+            }
+
+            WorldRouteLeg leg;
+            leg.map_id = start_map.map_id;
+            leg.start = start;
+            leg.end = goal;
+            leg.cost = out_cost;
+            out_legs.push_back(leg);
+            return true;
+        }
+
+        // One leg up to each transition of the chain, then the walk to the goal
+        out_cost = chain_cost;
+        for (size_t i = 0; i < chain.size(); ++i) {
+            const MapTransition& transition = world.transitions[chain[i]];
+            WorldRouteLeg leg;
+            leg.end = transition.position;
+            leg.transition = transition;
+            if (i == 0) {
+                leg.map_id = start_map.map_id;
+                leg.start = start;
+                leg.cost = start_walks.Get(start, transition.position);
+            }
+            else {
+                const int32_t previous = chain[i - 1];
+                const int32_t map_index = world.dest_maps[previous];
+                const uint32_t first = world.transition_offsets[map_index];
+                const uint32_t count = world.transition_offsets[map_index + 1] - first;
+                leg.map_id = world.map_ids[map_index];
+                leg.start = world.transitions[previous].dest_pos;
+                leg.cost = world.travel_costs[map_index].costs[static_cast<size_t>(world.arrival_rows[previous]) * count + (chain[i] - first)];
+            }
+            out_legs.push_back(leg);
+        }
+
+        WorldRouteLeg leg;
+        leg.map_id = goal_map.map_id;
+        leg.start = world.transitions[chain.back()].dest_pos;
+        leg.end = goal;
+        leg.cost = goal_walks.Get(leg.start, goal);
+        out_legs.push_back(leg);
+        return true;
+    }
+
+} // namespace Pathfinder
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "PathfinderCore.h"
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Pathfinder {
+
+    // One walk of a world route, ended by a transition (or by the goal for the last leg)
+    struct WorldRouteLeg {
+        int32_t map_id;
+        Vec2f start;                // Route start, or arrival of the previous transition
+        Vec2f end;                  // Position of the transition, or route goal
+        float cost;                 // Walking distance on the map
+        MapTransition transition;   // Taken at end (kind None for the last leg)
+
+        WorldRouteLeg() : map_id(0), start(), end(), cost(0.0f), transition() {}
+    };
+
+    /**
+     * @brief Graph of the transitions between maps, for routes across several maps
+     *
+     * Its nodes are the transitions of every map. Taking a transition leads to an arrival point of
+     * its destination map, from where each transition of that map costs the walk stored in the map's
+     * travel cost table; transitions themselves are free. Only travel data is kept, so the graph of
+     * the whole world is built from maps.nav without loading any map geometry.
+     */
+    struct WorldGraph {
+        std::vector<int32_t> map_ids;                   // Maps added, in order
+        std::vector<TravelCostTable> travel_costs;      // Of each map
+        std::vector<uint32_t> transition_offsets;       // CSR rows of the transitions of each map (plus the end)
+        std::vector<MapTransition> transitions;         // Columns of the travel costs of their map
+        std::vector<int32_t> dest_maps;                 // Index of the destination map of each transition (-1 if not added)
+        std::vector<int32_t> arrival_rows;              // Row of its dest_pos in the travel costs of that map (-1 if unknown)
+        std::unordered_map<int32_t, int32_t> map_indices;
+
+        WorldGraph() : transition_offsets(1, 0) {}
+
+        int32_t MapCount() const {
+            return static_cast<int32_t>(map_ids.size());
+        }
+
+        // Index of a map in map_ids (-1 if not added)
+        int32_t MapIndex(int32_t map_id) const {
+            auto it = map_indices.find(map_id);
+            return it != map_indices.end() ? it->second : -1;
+        }
+
+        /**
+         * @brief Adds the transitions and travel costs of a map (ignored if the map is already there)
+         * Call Link once every map is added.
+         */
+        void AddMap(const MapData& map_data);
+
+        // Resolves where each transition arrives
+        void Link();
+
+        /**
+         * @brief Cheapest chain of transitions (Dijkstra over the transitions)
+         * @param start_costs (transition, walking cost from the start to it) for the transitions a route can begin with
+         * @param goal_costs (transition, walking cost from its arrival to the goal) for the transitions a route can end with
+         * @param out_transitions Receives the transitions taken, in order
+         * @return Cost of the chain, infinity if there is none
+         */
+        float FindTransitions(const std::vector<std::pair<int32_t, float>>& start_costs,
+                              const std::vector<std::pair<int32_t, float>>& goal_costs,
+                              std::vector<int32_t>& out_transitions) const;
+    };
+
+    /**
+     * @brief Fills the travel cost table of a map (GWMapBaker)
+     * @param engine Engine running the walks
+     * @param map_data Map, loaded
+     * @param arrivals Distinct positions the transitions of every map lead to on this map
+     */
+    void BuildTravelCosts(PathfinderEngine& engine, MapData& map_data, const std::vector<Vec2f>& arrivals);
+
+    /**
+     * @brief Plans a route from a position on one map to a position on another
+     *
+     * Walks on the start and goal maps are searched on the maps given (they depend on the positions);
+     * the maps in between are only seen through the travel costs of the world graph. A route that
+     * stays on the start map is taken when it is the cheapest.
+     * @param engine Engine running the walks on the start and goal maps
+     * @param world World graph, linked
+     * @param start_map Map of the start (loaded)
+     * @param goal_map Map of the goal (loaded, may be start_map)
+     * @param out_legs Receives one leg per map walked
+     * @param out_cost Receives the total walking distance
+     * @return true if a route was found
+     */
+    bool FindWorldRoute(PathfinderEngine& engine, const WorldGraph& world,
+                        const MapData& start_map, const Vec2f& start, const MapData& goal_map, const Vec2f& goal,
+                        std::vector<WorldRouteLeg>& out_legs, float& out_cost);
+
+} // namespace Pathfinder